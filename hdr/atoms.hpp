@@ -100,6 +100,10 @@ namespace atoms
 	extern std::vector <int> category_array;
 	extern std::vector <int> grain_array;
 	extern std::vector <int> cell_array;
+	extern std::vector <int> uc_id_array; /// Atom number in unit cell (sublattice)
+	extern std::vector <int> x_supercell_array; /// Unit cell coordinates of atom
+	extern std::vector <int> y_supercell_array;
+	extern std::vector <int> z_supercell_array;
 
 	extern std::vector <double> x_spin_array;
 	extern std::vector <double> y_spin_array;
@@ -25,6 +25,7 @@
 #ifndef CELLS_H_
 #define CELLS_H_
 
+#include <stdint.h>
 #include <vector>
 #include <fstream>
 
@@ -38,14 +39,17 @@ namespace cells{
 
 	extern int num_cells;
 	extern int num_local_cells;
+	extern int num_cells_x; /// number of cells on regular grid in x,y,z
+	extern int num_cells_y;
+	extern int num_cells_z;
    extern int num_atoms_in_unit_cell;
 
 	extern double size;
 
 	extern bool initialised;
 
-	extern std::vector <int> num_atoms_in_cell;
-	extern std::vector <int> local_cell_array;
+	extern std::vector <int> num_atoms_in_cell; /// number of local atoms in each cell
+	extern std::vector <int> local_cell_array; /// cells owned by local CPU, for which fields are calculated
 
 	extern std::vector <double> x_coord_array;
 	extern std::vector <double> y_coord_array;
@@ -60,9 +64,39 @@ namespace cells{
 	extern std::vector <double> z_field_array;
 
    extern std::vector <double> volume_array;
+   extern std::vector <double> total_moment_array; /// saturation moment of each cell (J/T)
+
+	// cell magnetisation at last field update and relative change since
+	extern std::vector <double> x_mag_update_array;
+	extern std::vector <double> y_mag_update_array;
+	extern std::vector <double> z_mag_update_array;
+	extern std::vector <double> mag_change_array;
+	extern double max_mag_change;
+
+	// cell magnetisation accumulated during final loop of integrator
+	extern bool sweep_active;
+	extern bool sweep_valid;
+	extern uint64_t sweep_time; /// time at which accumulated magnetisation is valid
+	extern const int* sweep_cell;
+	extern const int* sweep_type;
+	extern std::vector <double> sweep_moment; /// moment of each material (J/T)
+	extern std::vector <double> x_sweep_mag_array;
+	extern std::vector <double> y_sweep_mag_array;
+	extern std::vector <double> z_sweep_mag_array;
+
+	inline void add_to_sweep(const int atom, const double sx, const double sy, const double sz){
+		const int cell = sweep_cell[atom];
+		const double mus = sweep_moment[sweep_type[atom]];
+		x_sweep_mag_array[cell] += sx*mus;
+		y_sweep_mag_array[cell] += sy*mus;
+		z_sweep_mag_array[cell] += sz*mus;
+	}
 
 	extern int initialise();
 	extern int mag();
+	extern void begin_sweep();
+	extern void end_sweep(const uint64_t time);
+	extern int distribute_field();
 	extern int output_mag(std::ofstream&);
 }
 
@@ -36,10 +36,54 @@
 namespace demag{
 
 	extern bool fast;
+	extern bool compressed;
+	extern bool fft;
 	extern int update_rate;
+	extern bool cache; /// read and write precalculated matrices from disk
+
+	extern const double prefactor;
+
+	// Adaptive update of fields driven by change in cell magnetisation,
+	// checked every update_rate timesteps
+	extern double update_tolerance;
+	extern int maximum_update_interval;
+	extern double partial_update_fraction;
+	extern double statistics_checks;
+	extern double statistics_full_updates;
+	extern double statistics_partial_updates;
 	
 	extern void init();
 	extern void update();
 
+	// Interaction tensor between macrocells, using cuboid (Newell) tensor within cutoff
+	extern bool newell;
+	extern double newell_cutoff;
+	extern void interaction_tensor(const double rx, const double ry, const double rz, double rij[6]);
+
+	// Periodic images of macrocells consistent with cs::pbc
+	extern bool periodic;
+	extern int periodic_images;
+	extern void periodic_init();
+
+	namespace internal{
+		extern void pair_tensor(const double rx, const double ry, const double rz, double rij[6]);
+		extern void periodic_tensor(const double rx, const double ry, const double rz, double rij[6]);
+	}
+
+	// FFT accelerated solver for regular macrocell grid
+	extern void fft_init();
+	extern void fft_update();
+
+	// Tree code solver for irregular geometries
+	extern bool tree;
+	extern double tree_opening_angle;
+	extern void tree_init();
+	extern void tree_update();
+
+	// Atomistic resolution solver by lattice FFT
+	extern bool atomistic;
+	extern void atomistic_init();
+	extern void atomistic_update();
+
 
 }
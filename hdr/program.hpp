@@ -46,6 +46,9 @@ namespace program
    extern void lagrange_multiplier();
    extern void localised_temperature_pulse();
    extern void effective_damping();
+   extern void parallel_tempering();
+   extern void wang_landau();
+   extern void dynamic_structure_factor();
 
 	// Sundry programs and diagnostics not under general release
 	extern int LLB_Boltzmann();
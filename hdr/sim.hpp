@@ -79,10 +79,25 @@ namespace sim{
 	extern double constraint_theta_max; /// loop angle max [degrees]
 	extern double constraint_theta_delta; /// loop angle delta [degrees]
 
+	extern int constraint_sweep_workers; /// number of independent runs sharing angle sweep
+	extern int constraint_sweep_worker; /// index of this run in angle sweep
+
 	// Monte Carlo variables
 	extern double mc_delta_angle; /// Tuned angle for Monte Carlo trial move
-	enum mc_algorithms { spin_flip, uniform, angle, hinzke_nowak};
+	extern bool mc_last_move_angle; /// True if last trial move was an angle move
+	enum mc_algorithms { spin_flip, uniform, angle, hinzke_nowak, heat_bath};
    extern mc_algorithms mc_algorithm; /// Selected algorith for Monte Carlo simulations
+   extern bool mc_adaptive_step_width; /// Tune Monte Carlo step width during equilibration
+   extern double mc_target_acceptance; /// Target acceptance ratio for tuned step width
+   extern bool mc_equilibrating; /// Set while the system is being equilibrated
+   extern std::vector<double> mc_step_width_scaling; /// Tuned scaling of step width for each material
+
+   // Wang-Landau variables
+   extern int wang_landau_bins; /// Number of energy bins for density of states
+   extern int wang_landau_windows; /// Number of overlapping energy windows
+   extern double wang_landau_flatness; /// Minimum ratio of smallest to mean histogram entry
+   extern double wang_landau_final_modification_factor; /// Final value of ln f
+   extern int wang_landau_maximum_sweeps; /// Maximum sweeps to reach window or flat histogram
 
 	extern double head_position[2];
 	extern double head_speed;
@@ -108,6 +123,7 @@ namespace sim{
 	extern int hamiltonian_simulation_flags[10];
 	
 	extern int integrator;
+	extern bool integrator_statistics; /// accumulate statistics and cell magnetisation in final LLG sweep
 	extern int program;
 	extern int AnisotropyType;
 	
@@ -143,6 +159,7 @@ namespace sim{
 	extern int run();
 	extern int initialise();
 	extern int integrate(int);
+	extern int equilibrate(int);
 	
 	// Legacy integrators
 	extern int LLB(int);
@@ -157,9 +174,14 @@ namespace sim{
 	extern int LLG_Midpoint_mpi();
 	extern int LLG_Midpoint_cuda();
 	extern int MonteCarlo();
+	extern int MonteCarlo_mpi();
 	extern int ConstrainedMonteCarlo();
 	extern int ConstrainedMonteCarloMonteCarlo();
+	extern int WolffMonteCarlo();
 	extern void mc_move(const std::valarray<double>&, std::valarray<double>&);
+	extern void mc_heat_bath(const int, const int, const double, std::valarray<double>&);
+	extern void mc_material_parameters(std::vector<double>&, std::vector<double>&);
+	extern void mc_tune_step_width(std::vector<double>&, std::vector<double>&);
 
 	// Integrator initialisers
 	extern void CMCinit();
@@ -168,6 +190,11 @@ namespace sim{
 
 	// Field and energy functions
 	extern double calculate_spin_energy(const int, const int);
+	extern double calculate_system_energy();
+	extern void calculate_material_energy(std::vector<double>&);
+	extern double calculate_spin_energy_difference(const int, const int, const double[3], const double[3]);
+	extern double spin_anisotropy_energy_difference(const int, const int, const double[3], const double[3]);
+	extern void spin_exchange_field(const int, const int, double[3]);
    extern double spin_exchange_energy_isotropic(const int, const double, const double , const double );
    extern double spin_exchange_energy_vector(const int, const double, const double, const double);
    extern double spin_exchange_energy_tensor(const int, const double, const double, const double);
@@ -195,6 +222,11 @@ namespace sim{
    extern double mc_statistics_moves;
    extern double mc_statistics_reject;
 
+   // Wolff cluster Monte Carlo statistics counters
+   extern double wolff_statistics_clusters;
+   extern double wolff_statistics_flipped;
+   extern double wolff_statistics_reject;
+
 }
 
 namespace cmc{
@@ -250,6 +282,14 @@ namespace cmc{
 	extern double mc_total;
 	extern double sphere_reject;
 	extern double energy_reject;
+
+	// Fixed size rotation helpers, matrices applied as S' = S.R
+	extern void polar_rot_matrix(const double, const double, double[3][3], double[3][3], double[3]);
+	extern void set_x_rotation_matrix(const double, double[3][3]);
+	extern void set_y_rotation_matrix(const double, double[3][3]);
+	extern void set_z_rotation_matrix(const double, double[3][3]);
+	extern void set_constraint_rotation_matrix(const double, const double, const double, double[3][3]);
+	extern void rotate_spins(const double[3][3], const int);
 }
 
 #endif /*SIM_H_*/
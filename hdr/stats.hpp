@@ -24,6 +24,9 @@
 //
 #ifndef STATS_H_
 #define STATS_H_
+#include <stdint.h>
+#include <complex>
+#include <fstream>
 #include <vector>
 #include <string>
 
@@ -40,6 +43,10 @@ namespace stats
 	// Member Functions
 	extern int mag_m();
 	extern void mag_m_reset();
+	extern void convergence_reset();
+	extern void convergence_update();
+	extern bool convergence_reached();
+	extern void convergence_log();
 	extern double max_torque();
 
 	extern bool calculate_torque;
@@ -79,8 +86,48 @@ namespace stats
    extern bool calculate_height_magnetization;
    extern bool calculate_material_height_magnetization;
    extern bool calculate_system_susceptibility;
+   extern bool calculate_histogram_reweighting;
+   extern int histogram_reweighting_points;
+   extern bool calculate_convergence;
+   extern bool calculate_structure_factor;
+   extern int structure_factor_rate;
+   extern int structure_factor_direction;
+   extern std::string dynamic_structure_factor_file;
+   extern double convergence_target_error;
+   extern int convergence_minimum_samples;
 
    class susceptibility_statistic_t;
+   class magnetization_statistic_t;
+
+   // Combined calculation of several magnetization statistics in a single pass
+   void calculate_magnetization(std::vector<magnetization_statistic_t*>& statistics, const std::vector<double>& sx,
+                                const std::vector<double>& sy, const std::vector<double>& sz, const std::vector<double>& mm);
+   void reduce_magnetization(std::vector<magnetization_statistic_t*>& statistics, std::vector<double>& magnetization);
+
+   // Accumulation of magnetization statistics during the final loop of an integrator
+   void begin_sweep(const std::vector<double>& mm);
+   void end_sweep(const uint64_t time);
+   void update_from_sweep();
+
+   extern bool sweep_active;  /// integrator accumulates statistics in current step
+   extern bool sweep_valid;
+   extern uint64_t sweep_time; /// time at which accumulated statistics are valid
+   extern int sweep_num_statistics;
+   extern std::vector<int> sweep_offset;
+   extern std::vector<const int*> sweep_mask;
+   extern std::vector<double> sweep_magnetization;
+   extern const double* sweep_moment;
+
+   inline void add_to_sweep(const int atom, const double sx, const double sy, const double sz){
+      const double mm = sweep_moment[atom];
+      for(int s=0; s<sweep_num_statistics; ++s){
+         const int idx = sweep_offset[s] + 4*sweep_mask[s][atom];
+         sweep_magnetization[idx + 0] += sx*mm;
+         sweep_magnetization[idx + 1] += sy*mm;
+         sweep_magnetization[idx + 2] += sz*mm;
+         sweep_magnetization[idx + 3] += mm;
+      }
+   }
 
    //----------------------------------
    // Magnetization Class definition
@@ -95,8 +142,11 @@ namespace stats
          bool is_initialized();
          void set_mask(const int mask_size, std::vector<int> inmask, const std::vector<double>& mm);
          void calculate_magnetization(const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz, const std::vector<double>& mm);
+         void set_magnetization(const std::vector<double>& totals, const int offset);
          void reset_magnetization_averages();
          const std::vector<double>& get_magnetization();
+         const std::vector<int>& get_mask();
+         int get_mask_size();
          std::string output_magnetization();
          std::string output_normalized_magnetization();
          std::string output_normalized_magnetization_length();
@@ -142,6 +192,140 @@ namespace stats
 
    };
 
+   //----------------------------------
+   // Histogram Reweighting Class definition
+   //----------------------------------
+   class reweighting_statistic_t{
+
+      public:
+         reweighting_statistic_t ();
+         void initialize(const int num_atoms, const std::vector<double>& mm);
+         void set_temperature(const double temperature);
+         void calculate(const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz, const std::vector<double>& mm, const double total_energy);
+         void output(std::string filename, const int num_points);
+
+      private:
+         bool initialized;
+         int num_atoms;
+         double saturation;
+         std::vector<double> temperatures;
+         std::vector<std::vector<double> > energy;
+         std::vector<std::vector<double> > magnetization;
+
+   };
+
+   //----------------------------------
+   // Convergence Class definition
+   //----------------------------------
+   class convergence_statistic_t{
+
+      public:
+         convergence_statistic_t ();
+         void initialize(const int num_values);
+         void set_relative_error(const int id);
+         void reset();
+         void add(const std::vector<double>& values);
+         bool is_converged(const double target_error, const int minimum_samples);
+         int get_num_samples();
+         double get_mean(const int id);
+         double get_standard_deviation(const int id);
+         double get_standard_error(const int id);
+         double get_autocorrelation_time(const int id);
+         std::string output_standard_error();
+         std::string output_autocorrelation_time();
+
+      private:
+         static const int minimum_blocks = 16; /// minimum number of blocks for error estimate
+         int num_values;
+         int num_samples;
+         std::vector<bool> relative_error;
+         std::vector<double> block_counter;
+         std::vector<std::vector<double> > block_mean;
+         std::vector<std::vector<double> > block_variance;
+         std::vector<std::vector<double> > pending;
+         std::vector<bool> has_pending;
+
+         double block_standard_error(const int level, const int id);
+
+   };
+
+   //----------------------------------
+   // Structure Factor Class definition
+   //----------------------------------
+   class structure_factor_statistic_t{
+
+      public:
+         structure_factor_statistic_t ();
+         void initialize(const int num_atoms, const std::vector<int>& cx, const std::vector<int>& cy, const std::vector<int>& cz,
+                         const std::vector<int>& sublattice_array, const int num_sublattices, const std::vector<double>& x,
+                         const std::vector<double>& y, const std::vector<double>& z, const double cell_size[3], const int direction);
+         void calculate(const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz);
+         void reset_averages();
+         void output(const double time, const double temperature);
+
+      private:
+         bool initialized;
+         int num_atoms;
+         int direction; /// 0 = radial average, 1-3 = along x,y,z
+         int num_sublattices;
+         int num_zones; /// reciprocal unit cells sampled in each direction
+         int cell_min[3];
+         int n[3];  /// unit cell grid dimensions
+         int np[3]; /// zero padded grid dimensions
+         double a[3];
+         double dq;
+         double dr;
+         double num_atoms_total;
+         double mean_counter;
+         std::vector<int> cell_array; /// grid index of each local atom
+         std::vector<double> offset;  /// position of each sublattice in unit cell (A)
+         std::vector<double> grid;
+         std::vector<std::complex<double> > work;
+         std::vector<std::vector<std::complex<double> > > transform; /// [sublattice*3+component][k]
+         std::vector<std::complex<double> > phase[3]; /// sublattice phase factors along x,y,z
+         std::vector<double> q_sum;
+         std::vector<double> q_modes;
+         std::vector<double> r_sum;
+         std::vector<double> r_pairs;
+         std::ofstream sq_file;
+         std::ofstream cr_file;
+
+         int q_bin(const int i, const int j, const int k);
+         int r_bin(const int i, const int j, const int k, const int sa, const int sb);
+         void fill_work(const std::vector<double>& cells, const int start);
+         void correlate(std::vector<double>& sum, const int num_components);
+
+   };
+
+   //----------------------------------
+   // Dynamic Structure Factor Class definition
+   //----------------------------------
+   class dynamic_structure_factor_statistic_t{
+
+      public:
+         dynamic_structure_factor_statistic_t ();
+         void initialize(const int num_atoms, const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z,
+                         const std::string q_point_file, const double cell_size[3], const int num_samples, const double sample_time);
+         void calculate(const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz);
+         void output(const std::string filename);
+
+      private:
+         bool initialized;
+         int num_atoms;
+         int num_q_points;
+         int num_samples;    /// maximum number of samples in time series
+         int sample_counter; /// number of samples stored
+         double sample_time; /// time between samples (s)
+         double num_atoms_total;
+         std::vector<double> coordinates; /// local atomic coordinates (A)
+         std::vector<double> q_points;    /// wavevectors (1/A)
+         std::vector<double> amplitude;   /// real and imaginary parts of x,y,z spin amplitudes at each q point
+         std::vector<double> time_series; /// amplitudes at each sample (root only)
+
+         void read_q_points(const std::string filename, const double cell_size[3]);
+
+   };
+
    // Statistics classes
    extern magnetization_statistic_t system_magnetization;
    extern magnetization_statistic_t material_magnetization;
@@ -149,6 +333,9 @@ namespace stats
    extern magnetization_statistic_t material_height_magnetization;
 
    extern susceptibility_statistic_t system_susceptibility;
+   extern reweighting_statistic_t histogram_reweighting;
+   extern convergence_statistic_t convergence;
+   extern structure_factor_statistic_t structure_factor;
    //extern susceptibility_statistic_t material_susceptibility;
 
 }
@@ -61,7 +61,7 @@ int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vecto
 
 	atoms::num_atoms = catom_array.size();
 	zlog << zTs() << "Number of atoms generated on rank " << vmpi::my_rank << ": " << atoms::num_atoms-vmpi::num_halo_atoms << std::endl; 
-	zlog << zTs() << "Memory required for copying to performance array on rank " << vmpi::my_rank << ": " << 19.0*double(atoms::num_atoms)*8.0/1.0e6 << " MB RAM"<< std::endl; 
+	zlog << zTs() << "Memory required for copying to performance array on rank " << vmpi::my_rank << ": " << 21.0*double(atoms::num_atoms)*8.0/1.0e6 << " MB RAM"<< std::endl; 
 	
 	atoms::x_coord_array.resize(atoms::num_atoms,0);
 	atoms::y_coord_array.resize(atoms::num_atoms,0);
@@ -76,6 +76,10 @@ int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vecto
 	atoms::category_array.resize(atoms::num_atoms,0);
 	atoms::grain_array.resize(atoms::num_atoms,0);
 	atoms::cell_array.resize(atoms::num_atoms,0);
+	atoms::uc_id_array.resize(atoms::num_atoms,0);
+	atoms::x_supercell_array.resize(atoms::num_atoms,0);
+	atoms::y_supercell_array.resize(atoms::num_atoms,0);
+	atoms::z_supercell_array.resize(atoms::num_atoms,0);
 	
 	atoms::x_total_spin_field_array.resize(atoms::num_atoms,0.0);
 	atoms::y_total_spin_field_array.resize(atoms::num_atoms,0.0);
@@ -101,6 +105,10 @@ int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vecto
 		atoms::category_array[atom] = catom_array[atom].lh_category;
 		//std::cout << atom << " grain: " << catom_array[atom].grain << std::endl;
 		atoms::grain_array[atom] = catom_array[atom].grain;
+		atoms::uc_id_array[atom] = catom_array[atom].uc_id;
+		atoms::x_supercell_array[atom] = catom_array[atom].scx;
+		atoms::y_supercell_array[atom] = catom_array[atom].scy;
+		atoms::z_supercell_array[atom] = catom_array[atom].scz;
 
 		// initialise atomic spin positions
       // Use a normalised gaussian for uniform distribution on a unit sphere
@@ -52,6 +52,10 @@ namespace atoms{
 	std::vector <int> category_array(0);
 	std::vector <int> grain_array(0);
 	std::vector <int> cell_array(0);
+	std::vector <int> uc_id_array(0);
+	std::vector <int> x_supercell_array(0);
+	std::vector <int> y_supercell_array(0);
+	std::vector <int> z_supercell_array(0);
 
 	std::vector <double> x_spin_array(0);
 	std::vector <double> y_spin_array(0);
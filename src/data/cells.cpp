@@ -48,11 +48,13 @@
 #include "cells.hpp"
 #include "material.hpp"
 #include "errors.hpp"
+#include "sim.hpp"
 #include "vmpi.hpp"
 #include "vio.hpp"
 
 // System header files
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <iostream>
 
@@ -60,6 +62,9 @@ namespace cells{
 	
 	int num_cells=0;
 	int num_local_cells=0;
+	int num_cells_x=0;
+	int num_cells_y=0;
+	int num_cells_z=0;
    int num_atoms_in_unit_cell=0;
 	double size=7.0; // Angstroms
 
@@ -81,6 +86,51 @@ namespace cells{
 	std::vector <double> z_field_array;
 
    std::vector <double> volume_array;
+   std::vector <double> total_moment_array;
+
+	std::vector <double> x_mag_update_array;
+	std::vector <double> y_mag_update_array;
+	std::vector <double> z_mag_update_array;
+	std::vector <double> mag_change_array;
+	double max_mag_change=0.0;
+
+	bool sweep_active=false;
+	bool sweep_valid=false;
+	uint64_t sweep_time=0;
+	const int* sweep_cell=NULL;
+	const int* sweep_type=NULL;
+	std::vector <double> sweep_moment;
+	std::vector <double> x_sweep_mag_array;
+	std::vector <double> y_sweep_mag_array;
+	std::vector <double> z_sweep_mag_array;
+
+	// Macrocells are owned by the CPU holding most of their atoms, which calculates
+	// the field of the cell. Other CPUs send partial moments to the owner and
+	// receive the field back.
+	namespace internal{
+
+		std::vector <int> owner_array; /// owning CPU of each cell, -1 for empty cells
+
+		std::vector <int> send_num_array; /// cells with local atoms owned by each CPU
+		std::vector <int> send_start_index_array;
+		std::vector <int> send_cell_array;
+		std::vector <double> send_data_array;
+
+		std::vector <int> recv_num_array; /// owned cells with atoms on each CPU
+		std::vector <int> recv_start_index_array;
+		std::vector <int> recv_cell_array;
+		std::vector <double> recv_data_array;
+
+		std::vector <int> gather_num_array; /// number of cells owned by each CPU
+		std::vector <int> gather_start_index_array;
+		std::vector <int> gather_cell_array; /// owned cells of all CPUs in order of rank
+		std::vector <double> gather_data_array;
+		std::vector <double> owned_data_array;
+
+		void initialise_comms();
+		void reduce(std::vector<double>* arrays[], const int num_arrays);
+
+	}
 	
 /// @brief Cell initialiser function
 ///
@@ -119,6 +169,9 @@ namespace cells{
 		
 		//update total number of cells
 		cells::num_cells=ncellx*ncelly*ncellz;
+		cells::num_cells_x=ncellx;
+		cells::num_cells_y=ncelly;
+		cells::num_cells_z=ncellz;
 		
 		zlog << zTs() << "Macrocells in x,y,z: " << ncellx << "\t" << ncelly << "\t" << ncellz << std::endl;
 		zlog << zTs() << "Total number of macrocells: " << cells::num_cells << std::endl;
@@ -224,8 +277,12 @@ namespace cells{
 		
 		cells::num_atoms_in_cell.resize(cells::num_cells,0);
       cells::volume_array.resize(cells::num_cells,0.0);
+      cells::total_moment_array.resize(cells::num_cells,0.0);
 
-      std::vector<double> total_moment_array(cells::num_cells,0.0);
+		cells::x_mag_update_array.resize(cells::num_cells,0.0);
+		cells::y_mag_update_array.resize(cells::num_cells,0.0);
+		cells::z_mag_update_array.resize(cells::num_cells,0.0);
+		cells::mag_change_array.resize(cells::num_cells,0.0);
 
 		// Now add atoms to each cell as magnetic 'centre of mass'
 		for(int atom=0;atom<num_local_atoms;atom++){
@@ -239,13 +296,17 @@ namespace cells{
          cells::num_atoms_in_cell[local_cell]++;
 		}
 
+		// Determine owners of cells from number of local atoms
+		internal::initialise_comms();
+
+		// Total number of atoms in each cell
+		std::vector <double> total_atoms_array(cells::num_cells,0.0);
+		for(int cell=0;cell<cells::num_cells;cell++) total_atoms_array[cell]=double(cells::num_atoms_in_cell[cell]);
+
 		// For MPI sum coordinates from all CPUs
 		#ifdef MPICF
-			MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::num_atoms_in_cell[0],cells::num_cells,MPI_INT,MPI_SUM);
-			MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::x_coord_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
-			MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::y_coord_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
-			MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::z_coord_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
-         MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&total_moment_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
+			std::vector<double>* arrays[5]={&cells::x_coord_array,&cells::y_coord_array,&cells::z_coord_array,&total_moment_array,&total_atoms_array};
+			internal::reduce(arrays,5);
       #endif
 		
 		//if(vmpi::my_rank==0){
@@ -259,11 +320,11 @@ namespace cells{
 
 		// Now find mean coordinates via magnetic 'centre of mass'
 		for(int local_cell=0;local_cell<cells::num_cells;local_cell++){
-			if(cells::num_atoms_in_cell[local_cell]>0){
+			if(total_atoms_array[local_cell]>0.0){
             cells::x_coord_array[local_cell] = cells::x_coord_array[local_cell]/(total_moment_array[local_cell]);
             cells::y_coord_array[local_cell] = cells::y_coord_array[local_cell]/(total_moment_array[local_cell]);
             cells::z_coord_array[local_cell] = cells::z_coord_array[local_cell]/(total_moment_array[local_cell]);
-            cells::volume_array[local_cell] = double(cells::num_atoms_in_cell[local_cell])*atomic_volume;
+            cells::volume_array[local_cell] = total_atoms_array[local_cell]*atomic_volume;
          }
 			//if(vmpi::my_rank==0){
 			//vinfo << local_cell << "\t" << cells::num_atoms_in_cell[local_cell] << "\t";
@@ -272,20 +333,9 @@ namespace cells{
 			//}
 		}
 
-		//Set number of atoms in cell to zero
+		// Calculate number of local cells, for which fields are calculated on this CPU
 		for(int cell=0;cell<cells::num_cells;cell++){
-		  cells::num_atoms_in_cell[cell]=0;
-		}
-		
-		// Now re-update num_atoms in cell for local atoms only
-		for(int atom=0;atom<num_local_atoms;atom++){
-			int local_cell=atoms::cell_array[atom];
-			cells::num_atoms_in_cell[local_cell]++;
-		}
-		
-		// Calculate number of local cells
-		for(int cell=0;cell<cells::num_cells;cell++){
-			if(cells::num_atoms_in_cell[cell]!=0){
+			if(internal::owner_array[cell]==vmpi::my_rank){
 				cells::local_cell_array.push_back(cell);
 				cells::num_local_cells++;
 			}
@@ -306,7 +356,8 @@ namespace cells{
 
 /// @brief Cell magnetisation function
 ///
-/// @details Determines moment in each cell (J/T)
+/// @details Determines moment in each cell (J/T) and its change since the
+///          last demag field update, relative to the saturation moment of the cell
 ///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
@@ -332,11 +383,20 @@ int mag() {
   // Check for initialised arrays
   //if(cells::initialised!=true) cells::initialise();
 
-  for(int i=0; i<cells::num_cells; ++i) {
-    cells::x_mag_array[i] = 0.0;
-    cells::y_mag_array[i] = 0.0;
-    cells::z_mag_array[i] = 0.0;
+  // use moments accumulated by integrator for current spins if available
+  if(cells::sweep_valid==true && cells::sweep_time==sim::time){
+    cells::x_mag_array.swap(cells::x_sweep_mag_array);
+    cells::y_mag_array.swap(cells::y_sweep_mag_array);
+    cells::z_mag_array.swap(cells::z_sweep_mag_array);
+    cells::sweep_valid=false;
   }
+  else{
+
+    for(int i=0; i<cells::num_cells; ++i) {
+      cells::x_mag_array[i] = 0.0;
+      cells::y_mag_array[i] = 0.0;
+      cells::z_mag_array[i] = 0.0;
+    }
 
 #ifdef MPICF
     int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
@@ -344,25 +404,335 @@ int mag() {
     int num_local_atoms = atoms::num_atoms;
 #endif
 
-  // calulate total moment in each cell
-  for(int i=0;i<num_local_atoms;++i) {
-    int cell = atoms::cell_array[i];
-    int type = atoms::type_array[i];
-    const double mus = mp::material[type].mu_s_SI;
+    // calulate total moment in each cell
+    for(int i=0;i<num_local_atoms;++i) {
+      int cell = atoms::cell_array[i];
+      int type = atoms::type_array[i];
+      const double mus = mp::material[type].mu_s_SI;
+
+      cells::x_mag_array[cell] += atoms::x_spin_array[i]*mus;
+      cells::y_mag_array[cell] += atoms::y_spin_array[i]*mus;
+      cells::z_mag_array[cell] += atoms::z_spin_array[i]*mus;
+    }
 
-    cells::x_mag_array[cell] += atoms::x_spin_array[i]*mus;
-    cells::y_mag_array[cell] += atoms::y_spin_array[i]*mus;
-    cells::z_mag_array[cell] += atoms::z_spin_array[i]*mus;
   }
 
 #ifdef MPICF
-  // Reduce magnetisation on all nodes
-  MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::x_mag_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
-  MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::y_mag_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
-  MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&cells::z_mag_array[0],cells::num_cells,MPI_DOUBLE,MPI_SUM);
+  // Sum magnetisation on owning CPUs and gather on all nodes
+  std::vector<double>* arrays[3]={&cells::x_mag_array,&cells::y_mag_array,&cells::z_mag_array};
+  internal::reduce(arrays,3);
 #endif
 
+  // Determine change in magnetisation since last field update relative to cell moment
+  cells::max_mag_change=0.0;
+  for(int i=0; i<cells::num_cells; ++i) {
+    if(cells::total_moment_array[i]>0.0){
+      const double dx = cells::x_mag_array[i]-cells::x_mag_update_array[i];
+      const double dy = cells::y_mag_array[i]-cells::y_mag_update_array[i];
+      const double dz = cells::z_mag_array[i]-cells::z_mag_update_array[i];
+      cells::mag_change_array[i] = sqrt(dx*dx+dy*dy+dz*dz)/cells::total_moment_array[i];
+      if(cells::mag_change_array[i]>cells::max_mag_change) cells::max_mag_change=cells::mag_change_array[i];
+    }
+  }
+
   return EXIT_SUCCESS;
 }
 
+/// @brief Function to prepare accumulation of cell magnetisation during an integrator sweep
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    07/05/2012
+///
+/// @internal
+///	Created:		07/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void begin_sweep(){
+
+	cells::sweep_valid=false;
+	if(cells::initialised==false || atoms::cell_array.size()==0) return;
+
+	cells::x_sweep_mag_array.assign(cells::num_cells,0.0);
+	cells::y_sweep_mag_array.assign(cells::num_cells,0.0);
+	cells::z_sweep_mag_array.assign(cells::num_cells,0.0);
+
+	cells::sweep_moment.resize(mp::num_materials);
+	for(int mat=0;mat<mp::num_materials;mat++) cells::sweep_moment[mat]=mp::material[mat].mu_s_SI;
+
+	cells::sweep_cell=&atoms::cell_array[0];
+	cells::sweep_type=&atoms::type_array[0];
+	cells::sweep_active=true;
+
+	return;
+}
+
+/// @brief Function to mark accumulated cell magnetisation as valid for given time
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    07/05/2012
+///
+/// @internal
+///	Created:		07/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void end_sweep(const uint64_t time){
+
+	if(cells::sweep_active==true){
+		cells::sweep_valid=true;
+		cells::sweep_time=time;
+	}
+	cells::sweep_active=false;
+
+	return;
+}
+
+/// @brief Cell field distribution function
+///
+/// @details Sends fields of owned cells to all CPUs with atoms in those cells
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    30/04/2012
+///
+/// @return EXIT_SUCCESS
+///
+/// @internal
+///	Created:		30/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+int distribute_field(){
+
+	// check calling of routine if error checking is activated
+	if(err::check==true) std::cout << "cells::distribute_field has been called" << std::endl;
+
+#ifdef MPICF
+
+	using namespace cells::internal;
+
+	// pack fields of owned cells for contributing CPUs
+	for(unsigned int r=0;r<recv_cell_array.size();r++){
+		const int cell=recv_cell_array[r];
+		recv_data_array[3*r+0]=cells::x_field_array[cell];
+		recv_data_array[3*r+1]=cells::y_field_array[cell];
+		recv_data_array[3*r+2]=cells::z_field_array[cell];
+	}
+
+	std::vector<MPI::Request> requests(0);
+	for(int cpu=0;cpu<vmpi::num_processors;cpu++){
+		if(recv_num_array[cpu]>0) requests.push_back(MPI::COMM_WORLD.Isend(&recv_data_array[3*recv_start_index_array[cpu]],3*recv_num_array[cpu],MPI_DOUBLE,cpu,71));
+		if(send_num_array[cpu]>0) requests.push_back(MPI::COMM_WORLD.Irecv(&send_data_array[3*send_start_index_array[cpu]],3*send_num_array[cpu],MPI_DOUBLE,cpu,71));
+	}
+	std::vector<MPI::Status> stati(requests.size());
+	if(requests.size()>0) MPI::Request::Waitall(requests.size(),&requests[0],&stati[0]);
+
+	// unpack fields of cells owned by other CPUs
+	for(unsigned int s=0;s<send_cell_array.size();s++){
+		const int cell=send_cell_array[s];
+		cells::x_field_array[cell]=send_data_array[3*s+0];
+		cells::y_field_array[cell]=send_data_array[3*s+1];
+		cells::z_field_array[cell]=send_data_array[3*s+2];
+	}
+
+#endif
+
+	return EXIT_SUCCESS;
+}
+
+namespace internal{
+
+/// @brief Function to determine cell owners and communication lists
+///
+/// @details The owner of each cell is the CPU with most atoms in the cell,
+///          with ties resolved by lowest rank. Requires num_atoms_in_cell to
+///          hold the number of local atoms.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    30/04/2012
+///
+/// @internal
+///	Created:		30/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void initialise_comms(){
+
+	owner_array.resize(cells::num_cells);
+
+#ifdef MPICF
+
+	const int num_cpus=vmpi::num_processors;
+
+	// find CPU with most atoms in each cell
+	std::vector<int> count_rank_array(2*cells::num_cells);
+	for(int cell=0;cell<cells::num_cells;cell++){
+		count_rank_array[2*cell+0]=cells::num_atoms_in_cell[cell];
+		count_rank_array[2*cell+1]=vmpi::my_rank;
+	}
+	MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&count_rank_array[0],cells::num_cells,MPI_2INT,MPI_MAXLOC);
+	for(int cell=0;cell<cells::num_cells;cell++){
+		owner_array[cell] = (count_rank_array[2*cell+0]>0) ? count_rank_array[2*cell+1] : -1;
+	}
+
+	// cells with local atoms owned by other CPUs
+	send_num_array.assign(num_cpus,0);
+	for(int cell=0;cell<cells::num_cells;cell++){
+		if(cells::num_atoms_in_cell[cell]>0 && owner_array[cell]!=vmpi::my_rank) send_num_array[owner_array[cell]]++;
+	}
+	send_start_index_array.assign(num_cpus,0);
+	for(int cpu=1;cpu<num_cpus;cpu++) send_start_index_array[cpu]=send_start_index_array[cpu-1]+send_num_array[cpu-1];
+	const int num_send_cells=send_start_index_array[num_cpus-1]+send_num_array[num_cpus-1];
+
+	send_cell_array.resize(num_send_cells);
+	std::vector<int> counter=send_start_index_array;
+	for(int cell=0;cell<cells::num_cells;cell++){
+		if(cells::num_atoms_in_cell[cell]>0 && owner_array[cell]!=vmpi::my_rank) send_cell_array[counter[owner_array[cell]]++]=cell;
+	}
+
+	// owned cells with atoms on other CPUs
+	recv_num_array.resize(num_cpus);
+	MPI::COMM_WORLD.Alltoall(&send_num_array[0],1,MPI_INT,&recv_num_array[0],1,MPI_INT);
+	recv_start_index_array.assign(num_cpus,0);
+	for(int cpu=1;cpu<num_cpus;cpu++) recv_start_index_array[cpu]=recv_start_index_array[cpu-1]+recv_num_array[cpu-1];
+	const int num_recv_cells=recv_start_index_array[num_cpus-1]+recv_num_array[num_cpus-1];
+
+	recv_cell_array.resize(num_recv_cells);
+	MPI::COMM_WORLD.Alltoallv(&send_cell_array[0],&send_num_array[0],&send_start_index_array[0],MPI_INT,
+									  &recv_cell_array[0],&recv_num_array[0],&recv_start_index_array[0],MPI_INT);
+
+	// owned cells of all CPUs
+	std::vector<int> owned_cell_array(0);
+	for(int cell=0;cell<cells::num_cells;cell++) if(owner_array[cell]==vmpi::my_rank) owned_cell_array.push_back(cell);
+	const int num_owned_cells=owned_cell_array.size();
+
+	gather_num_array.resize(num_cpus);
+	MPI::COMM_WORLD.Allgather(&num_owned_cells,1,MPI_INT,&gather_num_array[0],1,MPI_INT);
+	gather_start_index_array.assign(num_cpus,0);
+	for(int cpu=1;cpu<num_cpus;cpu++) gather_start_index_array[cpu]=gather_start_index_array[cpu-1]+gather_num_array[cpu-1];
+
+	gather_cell_array.resize(gather_start_index_array[num_cpus-1]+gather_num_array[num_cpus-1]);
+	MPI::COMM_WORLD.Allgatherv(&owned_cell_array[0],num_owned_cells,MPI_INT,
+										&gather_cell_array[0],&gather_num_array[0],&gather_start_index_array[0],MPI_INT);
+
+	zlog << zTs() << "Macrocells shared with other CPUs on rank " << vmpi::my_rank << ": " << num_send_cells << " sent, " << num_recv_cells << " received" << std::endl;
+
+#else
+
+	for(int cell=0;cell<cells::num_cells;cell++){
+		owner_array[cell] = (cells::num_atoms_in_cell[cell]>0) ? 0 : -1;
+	}
+
+#endif
+
+	return;
+
+}
+
+/// @brief Function to sum cell data from all CPUs
+///
+/// @details Partial sums for cells with local atoms are sent to the owning
+///          CPU, and the totals for all owned cells are then gathered on all
+///          CPUs. Entries for empty cells are not modified.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    30/04/2012
+///
+/// @internal
+///	Created:		30/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void reduce(std::vector<double>* arrays[], const int num_arrays){
+
+#ifdef MPICF
+
+	const int num_cpus=vmpi::num_processors;
+
+	// pack partial sums for owning CPUs
+	send_data_array.resize(num_arrays*send_cell_array.size());
+	recv_data_array.resize(num_arrays*recv_cell_array.size());
+	for(unsigned int s=0;s<send_cell_array.size();s++){
+		for(int a=0;a<num_arrays;a++) send_data_array[num_arrays*s+a]=(*arrays[a])[send_cell_array[s]];
+	}
+
+	std::vector<MPI::Request> requests(0);
+	for(int cpu=0;cpu<num_cpus;cpu++){
+		if(send_num_array[cpu]>0) requests.push_back(MPI::COMM_WORLD.Isend(&send_data_array[num_arrays*send_start_index_array[cpu]],num_arrays*send_num_array[cpu],MPI_DOUBLE,cpu,70));
+		if(recv_num_array[cpu]>0) requests.push_back(MPI::COMM_WORLD.Irecv(&recv_data_array[num_arrays*recv_start_index_array[cpu]],num_arrays*recv_num_array[cpu],MPI_DOUBLE,cpu,70));
+	}
+	std::vector<MPI::Status> stati(requests.size());
+	if(requests.size()>0) MPI::Request::Waitall(requests.size(),&requests[0],&stati[0]);
+
+	// add contributions from other CPUs to owned cells
+	for(unsigned int r=0;r<recv_cell_array.size();r++){
+		for(int a=0;a<num_arrays;a++) (*arrays[a])[recv_cell_array[r]]+=recv_data_array[num_arrays*r+a];
+	}
+
+	// gather totals for owned cells on all CPUs
+	const int start=gather_start_index_array[vmpi::my_rank];
+	const int num_owned_cells=gather_num_array[vmpi::my_rank];
+	owned_data_array.resize(num_arrays*num_owned_cells);
+	gather_data_array.resize(num_arrays*gather_cell_array.size());
+	for(int oc=0;oc<num_owned_cells;oc++){
+		for(int a=0;a<num_arrays;a++) owned_data_array[num_arrays*oc+a]=(*arrays[a])[gather_cell_array[start+oc]];
+	}
+
+	std::vector<int> counts(num_cpus);
+	std::vector<int> displacements(num_cpus);
+	for(int cpu=0;cpu<num_cpus;cpu++){
+		counts[cpu]=num_arrays*gather_num_array[cpu];
+		displacements[cpu]=num_arrays*gather_start_index_array[cpu];
+	}
+	MPI::COMM_WORLD.Allgatherv(&owned_data_array[0],num_arrays*num_owned_cells,MPI_DOUBLE,
+										&gather_data_array[0],&counts[0],&displacements[0],MPI_DOUBLE);
+
+	for(unsigned int g=0;g<gather_cell_array.size();g++){
+		for(int a=0;a<num_arrays;a++) (*arrays[a])[gather_cell_array[g]]=gather_data_array[num_arrays*g+a];
+	}
+
+#else
+
+	// serial totals are already complete
+	(void)arrays;
+	(void)num_arrays;
+
+#endif
+
+	return;
+
+}
+
+} // end of namespace internal
+
 }  // End of namespace cells   
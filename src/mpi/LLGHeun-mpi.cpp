@@ -28,6 +28,8 @@
 #include "errors.hpp"
 #include "LLG.hpp"
 #include "sim.hpp"
+#include "cells.hpp"
+#include "stats.hpp"
 #include "vmpi.hpp"
 
 #include <cmath>
@@ -298,6 +300,10 @@ int LLG_Heun_mpi(){
 			atoms::x_spin_array[atom]=S_new[0];
 			atoms::y_spin_array[atom]=S_new[1];
 			atoms::z_spin_array[atom]=S_new[2];
+
+			// Accumulate statistics for new spins
+			if(stats::sweep_active) stats::add_to_sweep(atom,S_new[0],S_new[1],S_new[2]);
+			if(cells::sweep_active) cells::add_to_sweep(atom,S_new[0],S_new[1],S_new[2]);
 		}
 
 	// Swap timers compute -> wait
@@ -29,6 +29,8 @@
 #include "errors.hpp"
 #include "LLG.hpp"
 #include "sim.hpp"
+#include "cells.hpp"
+#include "stats.hpp"
 #include "vmpi.hpp"
 
 // Standard Libraries
@@ -228,6 +230,10 @@ int LLG_Midpoint_mpi(){
 		atoms::x_spin_array[atom]=x_spin_storage_array[atom];
 		atoms::y_spin_array[atom]=y_spin_storage_array[atom];
 		atoms::z_spin_array[atom]=z_spin_storage_array[atom];
+
+		// Accumulate statistics for new spins
+		if(stats::sweep_active) stats::add_to_sweep(atom,x_spin_storage_array[atom],y_spin_storage_array[atom],z_spin_storage_array[atom]);
+		if(cells::sweep_active) cells::add_to_sweep(atom,x_spin_storage_array[atom],y_spin_storage_array[atom],z_spin_storage_array[atom]);
 	}
 
 	// Wait for other processors
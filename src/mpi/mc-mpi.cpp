@@ -0,0 +1,260 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains the domain decomposed Monte Carlo integrator
+///
+/// @details Single spin moves are only independent if no two processors
+///          update interacting spins at the same time. Each local domain is
+///          therefore split into eight octants which are updated in turn,
+///          so that simultaneously active octants on neighbouring processors
+///          are separated by half a domain width. Halo spins are exchanged
+///          after each octant, with communication overlapping the update
+///          of core atoms.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    14/03/2012
+/// @internal
+///	Created:		14/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+#ifdef MPICF
+// Standard Libraries
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "create.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+int mpi_init_halo_swap();
+int mpi_complete_halo_swap();
+
+namespace mc_mpi{
+
+	bool initialised=false;
+
+	// Lists of core and boundary atoms in each octant of the local domain
+	std::vector<std::vector<int> > core_octant_atoms(8);
+	std::vector<std::vector<int> > bdry_octant_atoms(8);
+
+	//-----------------------------------------------------------------------------
+	// Function to sort local atoms into octants of the local domain
+	//-----------------------------------------------------------------------------
+	void initialise(){
+
+		// check calling of routine if error checking is activated
+		if(err::check==true){std::cout << "mc_mpi::initialise has been called" << std::endl;}
+
+		// Checkerboard decomposition only makes sense for spatial domains
+		if(vmpi::mpi_mode!=0){
+			terminaltextcolor(RED);
+			std::cerr << "Error - Monte Carlo Integrator requires geometric decomposition for parallel execution" << std::endl;
+			terminaltextcolor(WHITE);
+			zlog << zTs() << "Error - Monte Carlo Integrator requires geometric decomposition for parallel execution" << std::endl;
+			err::vexit();
+		}
+
+		double midpoint[3];
+		for(int i=0;i<3;i++){
+			midpoint[i]=0.5*(vmpi::min_dimensions[i]+vmpi::max_dimensions[i]);
+
+			// Check that octants are wider than the interaction range
+			const double half_width = 0.5*(vmpi::max_dimensions[i]-vmpi::min_dimensions[i]);
+			const double range = double(cs::unit_cell.interaction_range)*cs::unit_cell.dimensions[i];
+			if(half_width < range){
+				terminaltextcolor(RED);
+				std::cerr << "Error - local domain is too small for parallel Monte Carlo: half width " << half_width
+							 << " A is less than the interaction range " << range << " A. Use fewer processors." << std::endl;
+				terminaltextcolor(WHITE);
+				zlog << zTs() << "Error - local domain is too small for parallel Monte Carlo: half width " << half_width
+					  << " A is less than the interaction range " << range << " A" << std::endl;
+				err::vexit();
+			}
+		}
+
+		for(int oct=0;oct<8;oct++){
+			core_octant_atoms[oct].resize(0);
+			bdry_octant_atoms[oct].resize(0);
+		}
+
+		const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+
+		for(int atom=0;atom<num_local_atoms;atom++){
+			int octant = 0;
+			if(atoms::x_coord_array[atom] >= midpoint[0]) octant+=1;
+			if(atoms::y_coord_array[atom] >= midpoint[1]) octant+=2;
+			if(atoms::z_coord_array[atom] >= midpoint[2]) octant+=4;
+			if(atom<vmpi::num_core_atoms) core_octant_atoms[octant].push_back(atom);
+			else bdry_octant_atoms[octant].push_back(atom);
+		}
+
+		initialised=true;
+
+		return;
+	}
+
+} // end of namespace mc_mpi
+
+namespace sim{
+
+/// @brief Domain decomposed Monte Carlo Integrator
+///
+/// @details Performs a single Monte Carlo step consisting of one trial move
+///          per local atom. Octants are updated sequentially, boundary atoms
+///          first so that their new positions can be sent while core atoms
+///          are updated.
+///
+/// @return EXIT_SUCCESS
+///
+int MonteCarlo_mpi(){
+
+	// Check for calling of function
+	if(err::check==true) std::cout << "sim::MonteCarlo_mpi has been called" << std::endl;
+
+	// Check for initialisation of octant lists
+	if(mc_mpi::initialised==false) mc_mpi::initialise();
+
+	// Declare arrays for spin states
+	std::valarray<double> Sold(3);
+	std::valarray<double> Snew(3);
+
+	// Temporaries
+	double DE=0.0;
+	const int AtomExchangeType=atoms::exchange_type;
+	const bool use_heat_bath = (sim::mc_algorithm==sim::heat_bath);
+
+	// Material dependent temperature rescaling and move widths
+	std::vector<double> rescaled_material_kBTBohr;
+	std::vector<double> sigma_array; // range for tuned gaussian random move
+	sim::mc_material_parameters(rescaled_material_kBTBohr, sigma_array);
+
+	// Material dependent statistics of angle moves for step width tuning
+	const bool tune = sim::mc_adaptive_step_width && sim::mc_equilibrating;
+	std::vector<double> material_moves(mp::num_materials,0.0);
+	std::vector<double> material_reject(mp::num_materials,0.0);
+
+	double statistics_moves = 0.0;
+	double statistics_reject = 0.0;
+
+	// loop over octants
+	for(int octant=0;octant<8;octant++){
+
+		// boundary atoms first (pass=0), then core atoms (pass=1) while halo is in flight
+		for(int pass=0;pass<2;pass++){
+
+			if(pass==1) mpi_init_halo_swap();
+
+			const std::vector<int>& atom_list = (pass==0) ? mc_mpi::bdry_octant_atoms[octant] : mc_mpi::core_octant_atoms[octant];
+			const int nmoves = atom_list.size();
+
+			for(int i=0;i<nmoves;i++){
+
+				// add one to number of moves counter
+				statistics_moves+=1.0;
+
+				// pick atom
+				const int atom = atom_list[int(nmoves*mtrandom::grnd())];
+
+				// get material id
+				const int imaterial=atoms::type_array[atom];
+
+				// Calculate range for move
+				sim::mc_delta_angle=sigma_array[imaterial];
+
+				// Save old spin position
+				Sold[0] = atoms::x_spin_array[atom];
+				Sold[1] = atoms::y_spin_array[atom];
+				Sold[2] = atoms::z_spin_array[atom];
+
+				// Draw new spin from local field, correcting for anisotropy only
+				if(use_heat_bath){
+					sim::mc_heat_bath(atom, AtomExchangeType, mp::material[imaterial].mu_s_SI*1.07828231e23*rescaled_material_kBTBohr[imaterial], Snew);
+					DE = sim::spin_anisotropy_energy_difference(atom, imaterial, &Sold[0], &Snew[0])*mp::material[imaterial].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+				}
+				else{
+					// Make Monte Carlo move
+					sim::mc_move(Sold, Snew);
+
+					// Calculate difference in Joules/mu_B
+					DE = sim::calculate_spin_energy_difference(atom, AtomExchangeType, &Sold[0], &Snew[0])*mp::material[imaterial].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+				}
+
+				// Accept lower energy states unconditionally, otherwise evaluate probability for move
+				if(DE<0 || exp(-DE*rescaled_material_kBTBohr[imaterial]) >= mtrandom::grnd()){
+					atoms::x_spin_array[atom] = Snew[0];
+					atoms::y_spin_array[atom] = Snew[1];
+					atoms::z_spin_array[atom] = Snew[2];
+				}
+				// add one to rejection counter
+				else{
+					statistics_reject += 1.0;
+					if(tune && sim::mc_last_move_angle) material_reject[imaterial] += 1.0;
+				}
+				if(tune && sim::mc_last_move_angle) material_moves[imaterial] += 1.0;
+			}
+		}
+
+		// Complete halo swap before next octant is updated
+		mpi_complete_halo_swap();
+
+	}
+
+	// Save statistics to sim namespace variable
+	sim::mc_statistics_moves += statistics_moves;
+	sim::mc_statistics_reject += statistics_reject;
+
+	// Adjust step widths during equilibration
+	if(tune) sim::mc_tune_step_width(material_moves, material_reject);
+
+	// Swap timers compute -> wait
+	vmpi::TotalComputeTime+=vmpi::SwapTimer(vmpi::ComputeTime, vmpi::WaitTime);
+
+	// Wait for other processors
+	MPI::COMM_WORLD.Barrier();
+
+	// Swap timers wait -> compute
+	vmpi::TotalWaitTime+=vmpi::SwapTimer(vmpi::WaitTime, vmpi::ComputeTime);
+
+	return EXIT_SUCCESS;
+}
+
+} // end of namespace sim
+#endif
@@ -67,6 +67,11 @@ namespace program{
 /// are cycled. The system is initialised all spins along the constraint direction. After initialisation 
 /// the sytem is equilibrated for sim::equilibration timesteps before statistics are collected.
 ///
+/// Each constraint direction is an independent calculation, so the sweep can be shared between
+/// sim:constraint-angle-sweep-workers independent runs. Run i calculates the i-th contiguous block
+/// of directions, and concatenating the data in the output files of all runs in order gives the
+/// output of a single run over the whole sweep.
+///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
 /// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2011. All Rights Reserved.
@@ -93,6 +98,28 @@ void cmc_anisotropy(){
 		err::zexit("Program CMC-anisotropy requires Constrained Monte Carlo as the integrator. Check input file.");
 	}
 	
+	// Count constraint directions in sweep
+	int num_points=0;
+	for(double theta=sim::constraint_theta_min; theta<=sim::constraint_theta_max; theta+=sim::constraint_theta_delta){
+		for(double phi=sim::constraint_phi_min; phi<=sim::constraint_phi_max; phi+=sim::constraint_phi_delta) num_points++;
+	}
+
+	// Determine block of directions calculated by this run
+	const int num_workers=sim::constraint_sweep_workers;
+	const int worker=sim::constraint_sweep_worker;
+	if(worker>=num_workers){
+		terminaltextcolor(RED);
+		std::cerr << "Error - sim:constraint-angle-sweep-worker " << worker << " must be less than sim:constraint-angle-sweep-workers " << num_workers << std::endl;
+		terminaltextcolor(WHITE);
+		zlog << zTs() << "Error - sim:constraint-angle-sweep-worker " << worker << " must be less than sim:constraint-angle-sweep-workers " << num_workers << std::endl;
+		err::vexit();
+	}
+	const int first_point=(num_points*worker)/num_workers;
+	const int last_point=(num_points*(worker+1))/num_workers;
+	if(num_workers>1) zlog << zTs() << "Calculating constraint directions " << first_point+1 << " to " << last_point << " of " << num_points << std::endl;
+
+	int point=0;
+
 	// set minimum rotational angle
 	sim::constraint_theta=sim::constraint_theta_min;
 
@@ -104,7 +131,21 @@ void cmc_anisotropy(){
 
 		// perform azimuthal angle sweep
 		while(sim::constraint_phi<=sim::constraint_phi_max){
-			
+
+			// Skip directions calculated by other runs
+			if(point<first_point || point>=last_point){
+				point++;
+				sim::constraint_phi+=sim::constraint_phi_delta;
+				continue;
+			}
+
+			// First direction of block starts from new spin configuration
+			if(point==first_point){
+				sim::constraint_theta_changed=false;
+				sim::constraint_phi_changed=false;
+			}
+			point++;
+
 			// Re-initialise spin moments for CMC
 			sim::CMCinit();
 			
@@ -115,7 +156,7 @@ void cmc_anisotropy(){
 			while(sim::temperature<=sim::Tmax){
 
 				// Equilibrate system
-				sim::integrate(sim::equilibration_time);
+				sim::equilibrate(sim::equilibration_time);
 				
 				// Reset mean magnetisation counters
 				stats::mag_m_reset();
@@ -147,7 +188,8 @@ void cmc_anisotropy(){
 			sim::constraint_phi_changed=true;
 			
 		} // End of azimuthal angle sweep
-      if(vout::gnuplot_array_format) zmag << std::endl;
+		// end row if its last direction was calculated by this run
+		if(vout::gnuplot_array_format && point-1>=first_point && point-1<last_point) zmag << std::endl;
 
 		// Increment rotational angle
 		sim::constraint_theta+=sim::constraint_theta_delta;
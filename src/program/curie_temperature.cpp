@@ -67,6 +67,12 @@ namespace program{
 /// accoring to the input flag - either randomly or ordered.For the ordered case the temperature sequence
 /// increases from zero, for the random case the temperature decreases from the maximum temperature. After
 /// initialisation the sytem is equilibrated for sim::equilibration timesteps.
+/// If sim:histogram-reweighting is enabled the total energy and magnetisation of every sample are
+/// stored and combined after the loop to give M(T), chi(T) and the Binder cumulant on a fine
+/// temperature grid in reweighting.txt.
+/// If sim:convergence-target-error is set each temperature ends when the standard errors of the
+/// magnetisation (and energy if calculated) fall below the target, with sim:loop-time-steps as an
+/// upper bound.
 ///
 /// @section notes Implementation Notes
 /// Capable of hot>cold or cold>hot calculation. 
@@ -100,24 +106,36 @@ int curie_temperature(){
 	while(sim::temperature<=sim::Tmax){
 
 		// Equilibrate system
-		sim::integrate(sim::equilibration_time);
+		sim::equilibrate(sim::equilibration_time);
 		
 		// Reset mean magnetisation counters
 		stats::mag_m_reset();
+		stats::convergence_reset();
 		
 		// Reset start time
 		int start_time=sim::time;
 
-		// Simulate system
-		while(sim::time<sim::loop_time+start_time){
+		// Start new histogram at current temperature
+		if(stats::calculate_histogram_reweighting) stats::histogram_reweighting.set_temperature(sim::temperature);
+
+		// Simulate system until converged or for at most loop_time
+		while(sim::time<sim::loop_time+start_time && !stats::convergence_reached()){
 			
 			// Integrate system
 			sim::integrate(sim::partial_time);
 		
 			// Calculate magnetisation statistics
 			stats::mag_m();
+			stats::convergence_update();
+
+			// Record energy and magnetisation for reweighting
+			if(stats::calculate_histogram_reweighting){
+				const double energy = sim::calculate_system_energy();
+				stats::histogram_reweighting.calculate(atoms::x_spin_array, atoms::y_spin_array, atoms::z_spin_array, atoms::m_spin_array, energy);
+			}
 
 		}
+		stats::convergence_log();
 		
 		// Output data
 		vout::data();
@@ -126,6 +144,9 @@ int curie_temperature(){
 		sim::temperature+=sim::delta_temperature;
 		
 	} // End of temperature loop
+
+	// Interpolate between simulated temperatures with multiple histogram reweighting
+	if(stats::calculate_histogram_reweighting) stats::histogram_reweighting.output("reweighting.txt", stats::histogram_reweighting_points);
 		
 	return EXIT_SUCCESS;
 }
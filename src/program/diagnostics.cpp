@@ -127,7 +127,7 @@ void boltzmann_dist(){
 	sim::temperature=sim::temperature;
 
 	// Equilibrate system
-	sim::integrate(sim::equilibration_time);
+	sim::equilibrate(sim::equilibration_time);
 	
 	// Simulate system
 	while(sim::time<sim::total_time+sim::equilibration_time){
@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <iostream>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "create.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "program.hpp"
+#include "sim.hpp"
+#include "stats.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace program{
+
+//------------------------------------------------------------------------------------------------------
+// Program to calculate the dynamic structure factor S(q,w) over a time series
+//
+//    After equilibration the system is integrated for sim:total-time-steps steps, and every
+//    sim:time-steps-increment steps the spins are projected onto the q points listed in
+//    sim:dynamic-structure-factor-file. The stored amplitudes are transformed to frequency
+//    at the end of the simulation and written to dynamic-structure-factor.txt.
+//
+//------------------------------------------------------------------------------------------------------
+void dynamic_structure_factor(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true) std::cout << "program::dynamic_structure_factor has been called" << std::endl;
+
+   // Check q point file has been specified
+   if(stats::dynamic_structure_factor_file==""){
+      terminaltextcolor(RED);
+      std::cerr << "Error - dynamic structure factor program requires a list of q points - set sim:dynamic-structure-factor-file in input file. Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - dynamic structure factor program requires a list of q points - set sim:dynamic-structure-factor-file in input file. Exiting." << std::endl;
+      err::vexit();
+   }
+
+   // Number of samples in time series
+   const int num_samples = sim::partial_time>0 ? int(sim::total_time/uint64_t(sim::partial_time)) : 0;
+   if(num_samples<2){
+      terminaltextcolor(RED);
+      std::cerr << "Error - dynamic structure factor program requires sim:total-time-steps to be at least twice sim:time-steps-increment. Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - dynamic structure factor program requires sim:total-time-steps to be at least twice sim:time-steps-increment. Exiting." << std::endl;
+      err::vexit();
+   }
+
+   #ifdef MPICF
+      const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+   #else
+      const int num_local_atoms = atoms::num_atoms;
+   #endif
+
+   stats::dynamic_structure_factor_statistic_t dynamic_structure_factor;
+   dynamic_structure_factor.initialize(num_local_atoms, atoms::x_coord_array, atoms::y_coord_array, atoms::z_coord_array,
+                                       stats::dynamic_structure_factor_file, cs::unit_cell.dimensions, num_samples,
+                                       double(sim::partial_time)*mp::dt_SI);
+
+   double temp=sim::temperature;
+
+   // Set equilibration temperature
+   sim::temperature=sim::Teq;
+
+   // Equilibrate system
+   while(sim::time<sim::equilibration_time){
+
+      sim::equilibrate(sim::partial_time);
+
+      // Calculate magnetisation statistics
+      stats::mag_m();
+
+      // Output data
+      vout::data();
+   }
+
+   sim::temperature=temp;
+
+   // Reset mean magnetisation counters
+   stats::mag_m_reset();
+
+   // Perform time series, storing spin amplitudes at each sample
+   for(int sample=0; sample<num_samples; ++sample){
+
+      // Integrate system
+      sim::integrate(sim::partial_time);
+
+      // Project spins onto q points
+      dynamic_structure_factor.calculate(atoms::x_spin_array, atoms::y_spin_array, atoms::z_spin_array);
+
+      // Calculate magnetisation statistics
+      stats::mag_m();
+
+      // Output data
+      vout::data();
+
+   }
+
+   // Transform time series to frequency and output
+   dynamic_structure_factor.output("dynamic-structure-factor.txt");
+
+   return;
+
+}
+
+}//end of namespace program
@@ -61,6 +61,9 @@ namespace program{
 
 /// @brief Function to calculate the a field cooled magnetisation
 ///
+/// @details If sim:convergence-target-error is set, runs end when the standard errors of the
+/// field cooled magnetisation fall below the target, with sim:runs as an upper bound.
+///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
 /// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2010. All Rights Reserved.
@@ -80,8 +83,11 @@ void field_cool(){
 	// check calling of routine if error checking is activated
 	if(err::check==true){std::cout << "program::field_cool has been called" << std::endl;}
 
-	// Perform several runs if desired
-	for(int run=0;run<sim::runs; run++){
+	// Final states of runs are independent samples of the field cooled state
+	stats::convergence_reset();
+
+	// Perform several runs if desired, until converged
+	for(int run=0;run<sim::runs && !stats::convergence_reached(); run++){
 
 		// Set equilibration temperature and field
 		sim::temperature=sim::Teq;
@@ -89,7 +95,7 @@ void field_cool(){
 		// Equilibrate system
 		while(sim::time<sim::equilibration_time){
 			
-			sim::integrate(sim::partial_time);
+			sim::equilibrate(sim::partial_time);
 			
 			// Calculate magnetisation statistics
 			stats::mag_m();
@@ -142,8 +148,12 @@ void field_cool(){
 			vout::data();
 
 		}
+
+		// Add final state to convergence estimates
+		stats::convergence_update();
 		
 	} // end of run loop
+	stats::convergence_log();
 	
 } // end of field_cool()
 
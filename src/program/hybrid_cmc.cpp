@@ -131,7 +131,7 @@ void hybrid_cmc(){
 			while(sim::temperature<=sim::Tmax){
 
 				// Equilibrate system
-				sim::integrate(sim::equilibration_time);
+				sim::equilibrate(sim::equilibration_time);
 				
 				// Reset mean magnetisation counters
 				stats::mag_m_reset();
@@ -248,7 +248,7 @@ void reverse_hybrid_cmc(){
          while(sim::temperature<=sim::Tmax){
 
             // Equilibrate system
-            sim::integrate(sim::equilibration_time);
+            sim::equilibrate(sim::equilibration_time);
 
             // Reset mean magnetisation counters
             stats::mag_m_reset();
@@ -62,6 +62,8 @@ namespace program{
 ///
 /// @details Consists of a sequence of sub-calculations of fixed temperature. The system is initialised 
 /// ordered. After initialisation a whole hysteresis loop of the system and coercivity are calculated.
+/// If sim:convergence-target-error is set each field point ends when the standard errors of the
+/// magnetisation fall below the target, with sim:loop-time-steps as an upper bound.
 ///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
@@ -86,7 +88,7 @@ int hysteresis(){
 	
 	// Equilibrate system in saturation field
 	sim::H_applied=sim::Heq;
-	sim::integrate(sim::equilibration_time);
+	sim::equilibrate(sim::equilibration_time);
 		
 	// Setup min and max fields and increment (uT)
 	int iHmax=vmath::iround(double(sim::Hmax)*1.0E6);
@@ -106,17 +108,20 @@ int hysteresis(){
 			
 			// Reset mean magnetisation counters
 			stats::mag_m_reset();
+			stats::convergence_reset();
 
-			// Integrate system
-			while(sim::time<sim::loop_time+start_time){
+			// Integrate system until converged or for at most loop_time
+			while(sim::time<sim::loop_time+start_time && !stats::convergence_reached()){
 
 				// Integrate system
 				sim::integrate(sim::partial_time);
 			
 				// Calculate mag_m, mag
 				stats::mag_m();
+				stats::convergence_update();
 
 			}
+			stats::convergence_log();
 
 			// Output to screen and file after each field
 			vout::data();
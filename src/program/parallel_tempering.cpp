@@ -0,0 +1,286 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "program.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "stats.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace pt{
+
+   //-----------------------------------------------------------------------------
+   // Statistics accumulated separately for each temperature of the ladder
+   //-----------------------------------------------------------------------------
+   class temperature_statistics_t{
+
+      public:
+         stats::magnetization_statistic_t system_magnetization;
+         stats::magnetization_statistic_t material_magnetization;
+         stats::magnetization_statistic_t height_magnetization;
+         stats::magnetization_statistic_t material_height_magnetization;
+         stats::susceptibility_statistic_t system_susceptibility;
+
+         // initialise with masks of stats module
+         temperature_statistics_t():
+            system_magnetization(stats::system_magnetization),
+            material_magnetization(stats::material_magnetization),
+            height_magnetization(stats::height_magnetization),
+            material_height_magnetization(stats::material_height_magnetization),
+            system_susceptibility(stats::system_susceptibility){}
+
+         // update from current spin configuration, mirroring stats::update()
+         void update(){
+            std::vector<stats::magnetization_statistic_t*> statistics;
+            if(stats::calculate_system_magnetization)          statistics.push_back(&system_magnetization);
+            if(stats::calculate_material_magnetization)        statistics.push_back(&material_magnetization);
+            if(stats::calculate_height_magnetization)          statistics.push_back(&height_magnetization);
+            if(stats::calculate_material_height_magnetization) statistics.push_back(&material_height_magnetization);
+            stats::calculate_magnetization(statistics, atoms::x_spin_array, atoms::y_spin_array, atoms::z_spin_array, atoms::m_spin_array);
+            if(stats::calculate_system_susceptibility)         system_susceptibility.calculate(system_magnetization.get_magnetization());
+         }
+
+         // copy to stats module for output
+         void copy_to_stats(){
+            stats::system_magnetization = system_magnetization;
+            stats::material_magnetization = material_magnetization;
+            stats::height_magnetization = height_magnetization;
+            stats::material_height_magnetization = material_height_magnetization;
+            stats::system_susceptibility = system_susceptibility;
+         }
+
+   };
+
+   //-----------------------------------------------------------------------------
+   // Spin configuration of a single replica
+   //-----------------------------------------------------------------------------
+   class replica_t{
+
+      public:
+         std::vector<double> sx;
+         std::vector<double> sy;
+         std::vector<double> sz;
+         std::vector<double> energy; // energy of each material
+
+         replica_t():
+            sx(atoms::x_spin_array),
+            sy(atoms::y_spin_array),
+            sz(atoms::z_spin_array),
+            energy(mp::num_materials,0.0){}
+
+         void load(){
+            atoms::x_spin_array = sx;
+            atoms::y_spin_array = sy;
+            atoms::z_spin_array = sz;
+         }
+
+         void save(){
+            sx = atoms::x_spin_array;
+            sy = atoms::y_spin_array;
+            sz = atoms::z_spin_array;
+         }
+
+   };
+
+   //-----------------------------------------------------------------------------
+   // Function to integrate all replicas at their current temperatures. Monte
+   // Carlo step widths are tuned separately for each temperature.
+   //-----------------------------------------------------------------------------
+   void integrate(std::vector<replica_t>& replicas, const std::vector<int>& replica_at, const std::vector<double>& temperatures,
+                  std::vector<temperature_statistics_t>& statistics, std::vector<std::vector<double> >& step_width_scaling,
+                  const bool update_statistics){
+
+      for(unsigned int t=0; t<temperatures.size(); t++){
+         replica_t& replica = replicas[replica_at[t]];
+         replica.load();
+         sim::temperature = temperatures[t];
+         sim::mc_step_width_scaling.swap(step_width_scaling[t]);
+         if(update_statistics) sim::integrate(sim::partial_time);
+         else sim::equilibrate(sim::partial_time);
+         sim::mc_step_width_scaling.swap(step_width_scaling[t]);
+         sim::calculate_material_energy(replica.energy);
+         if(update_statistics) statistics[t].update();
+         replica.save();
+      }
+
+      return;
+
+   }
+
+   //-----------------------------------------------------------------------------
+   // Function to attempt swaps between neighbouring temperatures. Swaps are
+   // decided on the root process so that all CPUs agree.
+   //-----------------------------------------------------------------------------
+   void swap(const std::vector<replica_t>& replicas, std::vector<int>& replica_at, const std::vector<std::vector<double> >& beta,
+             const int parity, std::vector<double>& attempts, std::vector<double>& accepted){
+
+      const int num_temperatures = beta.size();
+
+      for(int t=parity; t<num_temperatures-1; t+=2){
+
+         const std::vector<double>& Ei = replicas[replica_at[t]].energy;
+         const std::vector<double>& Ej = replicas[replica_at[t+1]].energy;
+
+         // P = min(1, exp(sum_m (beta_i,m - beta_j,m)(E_i,m - E_j,m)))
+         double delta = 0.0;
+         for(int m=0; m<mp::num_materials; m++) delta += (beta[t][m]-beta[t+1][m])*(Ei[m]-Ej[m]);
+
+         int accept = 0;
+         if(vmpi::my_rank==0) accept = (delta >= 0.0 || exp(delta) >= mtrandom::grnd()) ? 1 : 0;
+         #ifdef MPICF
+            MPI::COMM_WORLD.Bcast(&accept,1,MPI_INT,0);
+         #endif
+
+         attempts[t]+=1.0;
+         if(accept==1){
+            accepted[t]+=1.0;
+            const int tmp = replica_at[t];
+            replica_at[t] = replica_at[t+1];
+            replica_at[t+1] = tmp;
+         }
+      }
+
+      return;
+
+   }
+
+} // end of namespace pt
+
+namespace program{
+
+//-----------------------------------------------------------------------------
+//
+//   Program to equilibrate a system using parallel tempering (replica
+//   exchange). Replicas are run at a ladder of temperatures from sim:Tmin
+//   to sim:Tmax in steps of sim:delta_temperature. Every sim:partial_time
+//   steps Metropolis swaps of configurations are attempted between
+//   neighbouring temperatures, alternating between even and odd pairs.
+//   Swaps use the energy of each material weighted by its rescaled
+//   temperature, consistent with the Monte Carlo integrators.
+//
+//   After sim:equilibration_time steps statistics are collected for each
+//   temperature over sim:loop_time steps and output in the order of the
+//   temperature ladder using the usual output file.
+//
+//   Under MPI every CPU holds its own domain of every replica so that all
+//   CPUs cooperate on each replica in turn.
+//
+//   Ref. K Hukushima and K Nemoto, J. Phys. Soc. Jpn. 65, 1604 (1996)
+//
+//-----------------------------------------------------------------------------
+void parallel_tempering(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true) std::cout << "program::parallel_tempering has been called" << std::endl;
+
+   // Set up temperature ladder
+   std::vector<double> temperatures;
+   for(double T=sim::Tmin; T<=sim::Tmax; T+=sim::delta_temperature) temperatures.push_back(T);
+   const int num_temperatures = temperatures.size();
+
+   if(num_temperatures<2 || sim::Tmin <= 0.0){
+      terminaltextcolor(RED);
+      std::cerr << "Error - parallel tempering requires at least two temperatures greater than zero" << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - parallel tempering requires at least two temperatures greater than zero, "
+           << num_temperatures << " temperatures with minimum " << sim::Tmin << " K specified" << std::endl;
+      err::vexit();
+   }
+
+   zlog << zTs() << "Starting parallel tempering with " << num_temperatures << " replicas from "
+        << sim::Tmin << " K to " << sim::Tmax << " K" << std::endl;
+
+   // Replicas start from the current configuration
+   std::vector<pt::replica_t> replicas(num_temperatures);
+
+   // Index of replica currently at each temperature
+   std::vector<int> replica_at(num_temperatures);
+   for(int t=0; t<num_temperatures; t++) replica_at[t]=t;
+
+   // Statistics for each temperature
+   std::vector<pt::temperature_statistics_t> statistics(num_temperatures);
+
+   // Inverse temperature of each material at each temperature, including the temperature
+   // rescaling used by the Monte Carlo integrators so that swaps sample the same ensemble
+   std::vector<std::vector<double> > beta(num_temperatures);
+   for(int t=0; t<num_temperatures; t++){
+      std::vector<double> kBTBohr;
+      std::vector<double> sigma_array;
+      sim::temperature = temperatures[t];
+      sim::mc_material_parameters(kBTBohr, sigma_array);
+      beta[t].resize(mp::num_materials);
+      for(int m=0; m<mp::num_materials; m++) beta[t][m] = kBTBohr[m]/9.27400915e-24;
+   }
+
+   // Monte Carlo step width scaling for each temperature
+   std::vector<std::vector<double> > step_width_scaling(num_temperatures, sim::mc_step_width_scaling);
+
+   // Swap acceptance for each pair of neighbouring temperatures
+   std::vector<double> attempts(num_temperatures,0.0);
+   std::vector<double> accepted(num_temperatures,0.0);
+
+   int parity=0;
+
+   // Equilibrate replicas
+   for(uint64_t step=0; step<sim::equilibration_time; step+=sim::partial_time){
+      pt::integrate(replicas, replica_at, temperatures, statistics, step_width_scaling, false);
+      pt::swap(replicas, replica_at, beta, parity, attempts, accepted);
+      parity=1-parity;
+   }
+
+   // Collect statistics
+   for(uint64_t step=0; step<sim::loop_time; step+=sim::partial_time){
+      pt::integrate(replicas, replica_at, temperatures, statistics, step_width_scaling, true);
+      pt::swap(replicas, replica_at, beta, parity, attempts, accepted);
+      parity=1-parity;
+   }
+
+   // Output data for each temperature
+   for(int t=0; t<num_temperatures; t++){
+      sim::temperature=temperatures[t];
+      statistics[t].copy_to_stats();
+      vout::data();
+   }
+
+   // Output swap statistics
+   zlog << zTs() << "Parallel tempering swap acceptance:" << std::endl;
+   for(int t=0; t<num_temperatures-1; t++){
+      const double rate = attempts[t] > 0.0 ? accepted[t]/attempts[t] : 0.0;
+      zlog << zTs() << "\t" << temperatures[t] << " K <-> " << temperatures[t+1] << " K : " << rate*100.0 << "%" << std::endl;
+   }
+
+   // Output tuned step widths for each temperature
+   if(sim::mc_adaptive_step_width){
+      for(int t=0; t<num_temperatures; t++){
+         for(unsigned int m=0; m<step_width_scaling[t].size(); m++){
+            zlog << zTs() << "\tStep width scaling at " << temperatures[t] << " K for material " << m << ": " << step_width_scaling[t][m] << std::endl;
+         }
+      }
+   }
+
+   // Leave lowest temperature replica and step widths in place
+   replicas[replica_at[0]].load();
+   sim::temperature=temperatures[0];
+   sim::mc_step_width_scaling=step_width_scaling[0];
+
+   return;
+
+}
+
+} // end of namespace program
@@ -86,7 +86,7 @@ void time_series(){
 	// Equilibrate system
 	while(sim::time<sim::equilibration_time){
 		
-		sim::integrate(sim::partial_time);
+		sim::equilibrate(sim::partial_time);
 		
 		// Calculate magnetisation statistics
 		stats::mag_m();
@@ -0,0 +1,450 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <valarray>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "program.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace wl{
+
+   const double kB = 1.3806503e-23;
+
+   //-----------------------------------------------------------------------------
+   // Random walker in energy space, restricted to a window of energy bins
+   //-----------------------------------------------------------------------------
+   class walker_t{
+
+      public:
+         double energy;      // total energy (J)
+         double moment[3];   // total moment (mu_B)
+
+         walker_t(const double in_emin, const double in_bin_width):
+            energy(0.0),
+            emin(in_emin),
+            bin_width(in_bin_width),
+            Sold(3),
+            Snew(3){
+            moment[0]=0.0;
+            moment[1]=0.0;
+            moment[2]=0.0;
+         }
+
+         // Energy bin of energy E, outside 0 - num_bins-1 if not in sampled range
+         int bin(const double E){
+            return int(floor((E-emin)/bin_width));
+         }
+
+         // Recalculate energy and moment from spin configuration to avoid drift
+         void update(){
+            energy = sim::calculate_system_energy();
+            moment[0]=0.0;
+            moment[1]=0.0;
+            moment[2]=0.0;
+            for(int atom=0; atom<atoms::num_atoms; atom++){
+               const double mu = atoms::m_spin_array[atom];
+               moment[0] += atoms::x_spin_array[atom]*mu;
+               moment[1] += atoms::y_spin_array[atom]*mu;
+               moment[2] += atoms::z_spin_array[atom]*mu;
+            }
+         }
+
+         //-----------------------------------------------------------------------------
+         // Single spin trial move. The move is accepted if accept(old bin, new bin)
+         // returns true. Returns new bin of walker.
+         //-----------------------------------------------------------------------------
+         template <class acceptance_t> int move(const std::vector<double>& sigma_array, acceptance_t& accept){
+
+            const int atom = int(atoms::num_atoms*mtrandom::grnd());
+            const int imaterial = atoms::type_array[atom];
+
+            sim::mc_delta_angle=sigma_array[imaterial];
+
+            Sold[0] = atoms::x_spin_array[atom];
+            Sold[1] = atoms::y_spin_array[atom];
+            Sold[2] = atoms::z_spin_array[atom];
+
+            sim::mc_move(Sold, Snew);
+
+            const double DE = sim::calculate_spin_energy_difference(atom, atoms::exchange_type, &Sold[0], &Snew[0])*mp::material[imaterial].mu_s_SI;
+
+            const int old_bin = bin(energy);
+            const int new_bin = bin(energy+DE);
+
+            if(accept(old_bin, new_bin)){
+               atoms::x_spin_array[atom] = Snew[0];
+               atoms::y_spin_array[atom] = Snew[1];
+               atoms::z_spin_array[atom] = Snew[2];
+               const double mu = atoms::m_spin_array[atom];
+               moment[0] += (Snew[0]-Sold[0])*mu;
+               moment[1] += (Snew[1]-Sold[1])*mu;
+               moment[2] += (Snew[2]-Sold[2])*mu;
+               energy += DE;
+               return new_bin;
+            }
+
+            return old_bin;
+
+         }
+
+      private:
+         double emin;
+         double bin_width;
+         std::valarray<double> Sold; // work arrays for trial moves
+         std::valarray<double> Snew;
+
+   };
+
+   //-----------------------------------------------------------------------------
+   // Acceptance moving walker towards a window of bins, used before sampling
+   //-----------------------------------------------------------------------------
+   class approach_t{
+
+      public:
+         approach_t(const int in_first, const int in_last): first(in_first), last(in_last){}
+
+         int distance(const int b){
+            if(b < first) return first-b;
+            if(b > last) return b-last;
+            return 0;
+         }
+
+         bool operator()(const int old_bin, const int new_bin){
+            return distance(new_bin) <= distance(old_bin);
+         }
+
+      private:
+         int first;
+         int last;
+
+   };
+
+   //-----------------------------------------------------------------------------
+   // Wang-Landau acceptance within a window, p = min(1, g(E_old)/g(E_new))
+   //-----------------------------------------------------------------------------
+   class wang_landau_t{
+
+      public:
+         wang_landau_t(const int in_first, const int in_last, std::vector<double>& in_lng): first(in_first), last(in_last), lng(in_lng){}
+
+         bool operator()(const int old_bin, const int new_bin){
+            if(new_bin < first || new_bin > last) return false;
+            if(old_bin < first || old_bin > last) return true;
+            const double d = lng[old_bin]-lng[new_bin];
+            return (d >= 0.0 || exp(d) >= mtrandom::grnd());
+         }
+
+      private:
+         int first;
+         int last;
+         std::vector<double>& lng;
+
+   };
+
+   //-----------------------------------------------------------------------------
+   // Function to exit when a walker fails to converge within the sweep limit
+   //-----------------------------------------------------------------------------
+   void sweep_limit_error(const int window, const char* task){
+      terminaltextcolor(RED);
+      std::cerr << "Error - Wang-Landau walker in window " << window << " failed to " << task << " within " << sim::wang_landau_maximum_sweeps
+                << " sweeps, increase sim:wang-landau-maximum-sweeps or sim:minimum-temperature. Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - Wang-Landau walker in window " << window << " failed to " << task << " within " << sim::wang_landau_maximum_sweeps
+           << " sweeps. Exiting." << std::endl;
+      err::vexit();
+   }
+
+   //-----------------------------------------------------------------------------
+   // Function to calculate log(sum(exp(x))) without overflow
+   //-----------------------------------------------------------------------------
+   double log_sum_exp(const std::vector<double>& x){
+      double max_x = -1.0e300;
+      for(unsigned int i=0; i<x.size(); i++) max_x = std::max(max_x, x[i]);
+      double sum = 0.0;
+      for(unsigned int i=0; i<x.size(); i++) sum += exp(x[i]-max_x);
+      return max_x + log(sum);
+   }
+
+} // end of namespace wl
+
+namespace program{
+
+//-----------------------------------------------------------------------------
+//
+//   Program to calculate the density of states g(E) of the system using the
+//   Wang-Landau algorithm. Thermodynamic averages at any temperature are then
+//   obtained from a single calculation by reweighting with exp(-E/kT).
+//
+//   The energy range is set by short canonical Monte Carlo runs at sim:Tmin
+//   and sim:Tmax, extended by three standard deviations of the energy but
+//   limited to the lowest and highest energies actually sampled, so that
+//   every bin is reachable. The range is divided into sim:wang-landau-energy-bins bins and covered by
+//   sim:wang-landau-windows overlapping windows, each sampled by its own
+//   random walker. Within a window ln g is increased by ln f for every
+//   visit, and ln f is halved whenever the histogram of visits is flat to
+//   sim:wang-landau-flatness, until it is below
+//   sim:wang-landau-final-modification-factor. Windows are joined by
+//   matching ln g in the overlapping bins. A walker not reaching its window
+//   or a flat histogram within sim:wang-landau-maximum-sweeps sweeps is an
+//   error.
+//
+//   The density of states and mean magnetisation in each bin are written to
+//   density-of-states.txt, and <E>, C, F, S and <|m|> from sim:Tmin to
+//   sim:Tmax in steps of sim:delta_temperature to wang-landau.txt. Since
+//   only ratios of g(E) are known within the sampled range, the entropy is
+//   given relative to its value at sim:Tmax, with F = <E> - TS.
+//
+//   Ref. F Wang and D P Landau, Phys. Rev. Lett. 86, 2050 (2001)
+//
+//-----------------------------------------------------------------------------
+void wang_landau(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true) std::cout << "program::wang_landau has been called" << std::endl;
+
+   // Walkers need the whole system, which is not available with spatial decomposition
+   #ifdef MPICF
+      terminaltextcolor(RED);
+      std::cerr << "Error - Wang-Landau program is not supported in parallel mode, please use the serial version" << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - Wang-Landau program is not supported in parallel mode" << std::endl;
+      err::vexit();
+   #endif
+
+   const int num_atoms = atoms::num_atoms;
+   const int num_bins = sim::wang_landau_bins;
+   const int num_windows = sim::wang_landau_windows;
+
+   if(sim::Tmin <= 0.0 || sim::Tmax <= sim::Tmin){
+      terminaltextcolor(RED);
+      std::cerr << "Error - Wang-Landau program requires 0 < sim:minimum-temperature < sim:maximum-temperature" << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - Wang-Landau program requires 0 < Tmin < Tmax, Tmin = " << sim::Tmin << " K, Tmax = " << sim::Tmax << " K" << std::endl;
+      err::vexit();
+   }
+
+   // Determine energy range from canonical simulations at Tmin and Tmax, extended by
+   // three standard deviations of the energy distribution. For small systems this can
+   // lie beyond the ground state, so limit the range to the extreme energies sampled.
+   double range[2];
+   for(int i=0; i<2; i++){
+      sim::temperature = i==0 ? sim::Tmin : sim::Tmax;
+      sim::equilibrate(sim::equilibration_time);
+      double sum_E = 0.0;
+      double sum_E2 = 0.0;
+      double n = 0.0;
+      double min_E = sim::calculate_system_energy();
+      double max_E = min_E;
+      for(uint64_t step=0; step<sim::loop_time; step+=sim::partial_time){
+         sim::integrate(sim::partial_time);
+         const double E = sim::calculate_system_energy();
+         sum_E += E;
+         sum_E2 += E*E;
+         n += 1.0;
+         min_E = std::min(min_E, E);
+         max_E = std::max(max_E, E);
+      }
+      const double mean_E = n > 0.0 ? sum_E/n : sim::calculate_system_energy();
+      const double sigma_E = n > 1.0 ? sqrt(std::max(0.0, sum_E2/n-mean_E*mean_E)) : 0.0;
+      range[i] = i==0 ? std::max(mean_E-3.0*sigma_E, min_E) : std::min(mean_E+3.0*sigma_E, max_E);
+   }
+   const double emin = range[0];
+   const double emax = range[1];
+
+   if(emax <= emin){
+      terminaltextcolor(RED);
+      std::cerr << "Error - energy range for Wang-Landau program is empty, increase sim:maximum-temperature" << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - energy range for Wang-Landau program is empty, Emin = " << emin << " J, Emax = " << emax << " J" << std::endl;
+      err::vexit();
+   }
+
+   // Trial move widths at highest temperature
+   std::vector<double> kBTBohr;
+   std::vector<double> sigma_array;
+   sim::mc_material_parameters(kBTBohr, sigma_array);
+
+   const double bin_width = (emax-emin)/double(num_bins);
+
+   zlog << zTs() << "Starting Wang-Landau sampling of " << num_bins << " energy bins from " << emin << " J to " << emax
+        << " J with " << num_windows << " windows" << std::endl;
+
+   // Windows overlap by half their width
+   const double window_width = double(num_bins)/(1.0+0.5*double(num_windows-1));
+   std::vector<int> first_bin(num_windows);
+   std::vector<int> last_bin(num_windows);
+   for(int w=0; w<num_windows; w++){
+      first_bin[w] = int(0.5*window_width*double(w)+0.5);
+      last_bin[w] = w==num_windows-1 ? num_bins-1 : int(0.5*window_width*double(w)+window_width+0.5)-1;
+   }
+
+   // Each window needs at least two bins and must overlap the previous window
+   for(int w=0; w<num_windows; w++){
+      if(last_bin[w]-first_bin[w]+1 < 2 || (w > 0 && last_bin[w-1] < first_bin[w])){
+         terminaltextcolor(RED);
+         std::cerr << "Error - " << num_bins << " energy bins are too few for " << num_windows << " Wang-Landau windows, "
+                   << "increase sim:wang-landau-energy-bins or reduce sim:wang-landau-windows. Exiting." << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Error - " << num_bins << " energy bins are too few for " << num_windows << " Wang-Landau windows. Exiting." << std::endl;
+         err::vexit();
+      }
+   }
+
+   // Density of states and microcanonical magnetisation for each window
+   std::vector<std::vector<double> > window_lng(num_windows, std::vector<double>(num_bins,0.0));
+   std::vector<std::vector<double> > window_m(num_windows, std::vector<double>(num_bins,0.0));
+   std::vector<std::vector<double> > window_counts(num_windows, std::vector<double>(num_bins,0.0));
+
+   wl::walker_t walker(emin, bin_width);
+   walker.update();
+
+   for(int w=0; w<num_windows; w++){
+
+      const int first = first_bin[w];
+      const int last = last_bin[w];
+      const int window_bins = last-first+1;
+
+      // Move walker into window, starting from configuration of previous window
+      wl::approach_t approach(first, last);
+      int bin = walker.bin(walker.energy);
+      for(int sweep=0; approach.distance(bin) > 0; sweep++){
+         if(sweep >= sim::wang_landau_maximum_sweeps) wl::sweep_limit_error(w+1, "reach its energy window");
+         for(int n=0; n<num_atoms; n++) bin = walker.move(sigma_array, approach);
+         walker.update();
+         bin = walker.bin(walker.energy);
+      }
+
+      std::vector<double>& lng = window_lng[w];
+      std::vector<double> histogram(num_bins,0.0);
+      wl::wang_landau_t wang_landau(first, last, lng);
+
+      double lnf = 1.0;
+      int stage = 0;
+      while(lnf > sim::wang_landau_final_modification_factor){
+
+         // Sweep until histogram is flat
+         bool flat = false;
+         std::vector<double>& m = window_m[w];
+         std::vector<double>& counts = window_counts[w];
+         for(int b=0; b<num_bins; b++){
+            histogram[b] = 0.0;
+            m[b] = 0.0;
+            counts[b] = 0.0;
+         }
+         walker.update();
+         bin = walker.bin(walker.energy);
+
+         for(int sweep=0; !flat; sweep++){
+            if(sweep >= sim::wang_landau_maximum_sweeps) wl::sweep_limit_error(w+1, "reach a flat histogram");
+            for(int n=0; n<num_atoms; n++){
+               bin = walker.move(sigma_array, wang_landau);
+               if(bin < first || bin > last) continue;
+               lng[bin] += lnf;
+               histogram[bin] += 1.0;
+               m[bin] += sqrt(walker.moment[0]*walker.moment[0]+walker.moment[1]*walker.moment[1]+walker.moment[2]*walker.moment[2]);
+               counts[bin] += 1.0;
+            }
+
+            double min_h = histogram[first];
+            double mean_h = 0.0;
+            for(int b=first; b<=last; b++){
+               min_h = std::min(min_h, histogram[b]);
+               mean_h += histogram[b]/double(window_bins);
+            }
+            flat = (min_h >= sim::wang_landau_flatness*mean_h);
+         }
+
+         stage++;
+         lnf *= 0.5;
+      }
+
+      zlog << zTs() << "Wang-Landau window " << w+1 << " of " << num_windows << " converged after " << stage << " stages" << std::endl;
+
+   }
+
+   // Join windows, switching at the middle of each overlap
+   std::vector<double> lng(num_bins,0.0);
+   std::vector<double> m(num_bins,0.0);
+   int switch_bin = 0;
+   double shift = 0.0;
+   for(int w=0; w<num_windows; w++){
+      if(w > 0){
+         const int overlap_first = first_bin[w];
+         const int overlap_last = last_bin[w-1];
+         double sum = 0.0;
+         for(int b=overlap_first; b<=overlap_last; b++) sum += lng[b]-window_lng[w][b];
+         shift = sum/double(overlap_last-overlap_first+1);
+         switch_bin = (overlap_first+overlap_last+1)/2;
+      }
+      for(int b=switch_bin; b<=last_bin[w]; b++){
+         lng[b] = window_lng[w][b]+shift;
+         m[b] = window_counts[w][b] > 0.0 ? window_m[w][b]/window_counts[w][b] : 0.0;
+      }
+   }
+
+   // Total moment for normalisation of magnetisation
+   double saturation = 0.0;
+   for(int atom=0; atom<num_atoms; atom++) saturation += atoms::m_spin_array[atom];
+
+   // Only relative values of g(E) are known, so normalise to zero entropy at Tmax
+   std::vector<double> lnw(num_bins);
+   const double beta_max = 1.0/(wl::kB*sim::Tmax);
+   for(int b=0; b<num_bins; b++) lnw[b] = lng[b]-beta_max*(emin+(double(b)+0.5)*bin_width);
+   const double lnZ_max = wl::log_sum_exp(lnw);
+   double mean_E_max = 0.0;
+   for(int b=0; b<num_bins; b++) mean_E_max += exp(lnw[b]-lnZ_max)*(emin+(double(b)+0.5)*bin_width);
+   const double norm = -(beta_max*mean_E_max + lnZ_max);
+   for(int b=0; b<num_bins; b++) lng[b] += norm;
+
+   std::ofstream dos_file("density-of-states.txt");
+   dos_file << "# Energy (J)\tln g(E)\t<|m|>(E)" << std::endl;
+   for(int b=0; b<num_bins; b++) dos_file << emin+(double(b)+0.5)*bin_width << "\t" << lng[b] << "\t" << m[b]/saturation << std::endl;
+   dos_file.close();
+
+   // Thermodynamic averages from density of states
+   std::ofstream ofile("wang-landau.txt");
+   ofile << "# Temperature (K)\t<E> (J)\tC (J/K)\tF (J)\tS-S(Tmax) (J/K)\t<|m|>" << std::endl;
+   for(double T=sim::Tmin; T<=sim::Tmax; T+=sim::delta_temperature){
+      const double beta = 1.0/(wl::kB*T);
+      for(int b=0; b<num_bins; b++) lnw[b] = lng[b]-beta*(emin+(double(b)+0.5)*bin_width);
+      const double lnZ = wl::log_sum_exp(lnw);
+      double mean_E = 0.0;
+      double mean_E2 = 0.0;
+      double mean_m = 0.0;
+      for(int b=0; b<num_bins; b++){
+         const double p = exp(lnw[b]-lnZ);
+         const double E = emin+(double(b)+0.5)*bin_width;
+         mean_E += p*E;
+         mean_E2 += p*E*E;
+         mean_m += p*m[b]/saturation;
+      }
+      const double C = (mean_E2-mean_E*mean_E)*beta/T;
+      const double F = -wl::kB*T*lnZ;
+      const double S = (mean_E-F)/T;
+      ofile << T << "\t" << mean_E << "\t" << C << "\t" << F << "\t" << S << "\t" << mean_m << std::endl;
+   }
+   ofile.close();
+
+   return;
+
+}
+
+} // end of namespace program
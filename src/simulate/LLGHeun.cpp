@@ -53,9 +53,11 @@
 
 // Vampire Header files
 #include "atoms.hpp"
+#include "cells.hpp"
 #include "errors.hpp"
 #include "LLG.hpp"
 #include "material.hpp"
+#include "stats.hpp"
 
 //Function prototypes
 int calculate_spin_fields(const int,const int);
@@ -277,6 +279,10 @@ int LLG_Heun(){
 		atoms::x_spin_array[atom]=S_new[0];
 		atoms::y_spin_array[atom]=S_new[1];
 		atoms::z_spin_array[atom]=S_new[2];
+
+		// Accumulate statistics for new spins
+		if(stats::sweep_active) stats::add_to_sweep(atom,S_new[0],S_new[1],S_new[2]);
+		if(cells::sweep_active) cells::add_to_sweep(atom,S_new[0],S_new[1],S_new[2]);
 	}
 
 	return EXIT_SUCCESS;
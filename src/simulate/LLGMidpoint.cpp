@@ -53,10 +53,12 @@
 
 // Vampire Header files
 #include "atoms.hpp"
+#include "cells.hpp"
 #include "errors.hpp"
 #include "LLG.hpp"
 #include "material.hpp"
 #include "sim.hpp"
+#include "stats.hpp"
 
 //Function prototypes
 int calculate_spin_fields(const int,const int);
@@ -181,6 +183,10 @@ int LLG_Midpoint(){
 		atoms::x_spin_array[atom] = one_o_one_plus_beta2FdotF*(S[0]*one_minus_beta2FdotF + 2.0*(beta*(F[1]*S[2]-F[2]*S[1]) + F[0]*beta2FdotS));
 		atoms::y_spin_array[atom] = one_o_one_plus_beta2FdotF*(S[1]*one_minus_beta2FdotF + 2.0*(beta*(F[2]*S[0]-F[0]*S[2]) + F[1]*beta2FdotS));
 		atoms::z_spin_array[atom] = one_o_one_plus_beta2FdotF*(S[2]*one_minus_beta2FdotF + 2.0*(beta*(F[0]*S[1]-F[1]*S[0]) + F[2]*beta2FdotS));
+
+		// Accumulate statistics for new spins
+		if(stats::sweep_active) stats::add_to_sweep(atom,atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]);
+		if(cells::sweep_active) cells::add_to_sweep(atom,atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]);
 	}
 
 	return EXIT_SUCCESS;
@@ -74,9 +74,9 @@ namespace cmc{
 	bool is_initialised=false;
 
 	// Rotational matrices
-	std::vector<std::vector<double> > polar_vector;
-	std::vector<std::vector<double> > polar_matrix_tp;
-	std::vector<std::vector<double> > polar_matrix;
+	double polar_vector[3];
+	double polar_matrix_tp[3][3];
+	double polar_matrix[3][3];
 
 ///
 /// @brief Sets up matrices for performing CMC in an arbitrary space
@@ -89,112 +89,112 @@ namespace cmc{
 /// @return			void
 ///
 void polar_rot_matrix(
-	double phi, 
-	double theta, 
-	std::vector< std::vector<double> > & polar_matrix, 
-	std::vector< std::vector<double> > & polar_matrix_tp, 
-	std::vector< std::vector<double> > & polar_vector)
+	const double phi, 
+	const double theta, 
+	double polar_matrix[3][3], 
+	double polar_matrix_tp[3][3], 
+	double polar_vector[3])
 {
-	double dx,dy,dz; //change in angle in radians
-	double ddx,ddy,ddz; //change in angle in degrees
+	double y_rotation_matrix[3][3];
+	double z_rotation_matrix[3][3];
+
+	// assumues x = cos(theta)sin(phi), y = sin(theta)sin(phi)
+	set_y_rotation_matrix(phi, y_rotation_matrix);
+	set_z_rotation_matrix(theta, z_rotation_matrix);
+
+	// polar_matrix = matmul(y_rotation_matrix, z_rotation_matrix)
+	for(int i=0;i<3;i++){
+		for(int j=0;j<3;j++){
+			polar_matrix[i][j]=y_rotation_matrix[i][0]*z_rotation_matrix[0][j]+
+									 y_rotation_matrix[i][1]*z_rotation_matrix[1][j]+
+									 y_rotation_matrix[i][2]*z_rotation_matrix[2][j];
+		}
+	}
 
-	double sin_x,sin_y,sin_z,cos_x,cos_y,cos_z;
-	std::vector<double> reference_vector(3);
+	for(int i=0;i<3;i++){
+		for(int j=0;j<3;j++) polar_matrix_tp[i][j]=polar_matrix[j][i];
+	}
 
-	double pi=3.14159265358979323846264338327;
+	// polar_vector = matmul((0,0,1), polar_matrix)
+	for(int j=0;j<3;j++) polar_vector[j]=polar_matrix[2][j];
 
-	//--------------------------------------------------
-	// Initialise varibales 
-	//--------------------------------------------------
+}
 
-	ddx = 0.0;
-	ddy = phi;
-	ddz = theta;// assumues x = cos(theta)sin(phi), y = sin(theta)sin(phi)
+/// Functions to set rotation matrices for an angle in degrees, applied as S' = S.R
+void set_x_rotation_matrix(const double ddx, double R[3][3]){
+	const double dx = (ddx/360.0)*2.0*M_PI;
+	const double sin_x = sin(dx);
+	const double cos_x = cos(dx);
+	R[0][0] = 1.0;   R[0][1] = 0.0;    R[0][2] = 0.0;
+	R[1][0] = 0.0;   R[1][1] = cos_x;  R[1][2] = sin_x;
+	R[2][0] = 0.0;   R[2][1] = -sin_x; R[2][2] = cos_x;
+}
 
-	dx = (ddx/360.0)*2.0*pi;
-	dy = (ddy/360.0)*2.0*pi;
-	dz = (ddz/360.0)*2.0*pi;
+void set_y_rotation_matrix(const double ddy, double R[3][3]){
+	const double dy = (ddy/360.0)*2.0*M_PI;
+	const double sin_y = sin(dy);
+	const double cos_y = cos(dy);
+	R[0][0] = cos_y; R[0][1] = 0.0;    R[0][2] = -sin_y;
+	R[1][0] = 0.0;   R[1][1] = 1.0;    R[1][2] = 0.0;
+	R[2][0] = sin_y; R[2][1] = 0.0;    R[2][2] = cos_y;
+}
 
-	reference_vector[0] = 0.0;
-	reference_vector[1] = 0.0;
-	reference_vector[2] = 1.0;
+void set_z_rotation_matrix(const double ddz, double R[3][3]){
+	const double dz = (ddz/360.0)*2.0*M_PI;
+	const double sin_z = sin(dz);
+	const double cos_z = cos(dz);
+	R[0][0] = cos_z; R[0][1] = sin_z;  R[0][2] = 0.0;
+	R[1][0] = -sin_z;R[1][1] = cos_z;  R[1][2] = 0.0;
+	R[2][0] = 0.0;   R[2][1] = 0.0;    R[2][2] = 1.0;
+}
+
+/// Function to set rotation matrix taking spins from theta_old to theta = 0 (reference direction
+/// along x), rotating by dphi around x and from theta = 0 to theta_new, all angles in degrees
+void set_constraint_rotation_matrix(const double theta_old, const double dphi, const double theta_new, double R[3][3]){
+	double z_old[3][3];
+	double x_rot[3][3];
+	double z_new[3][3];
+	set_z_rotation_matrix(-theta_old, z_old);
+	set_x_rotation_matrix(dphi, x_rot);
+	set_z_rotation_matrix(theta_new, z_new);
+
+	double zx[3][3];
+	for(int i=0;i<3;i++){
+		for(int j=0;j<3;j++) zx[i][j]=z_old[i][0]*x_rot[0][j]+z_old[i][1]*x_rot[1][j]+z_old[i][2]*x_rot[2][j];
+	}
+	for(int i=0;i<3;i++){
+		for(int j=0;j<3;j++) R[i][j]=zx[i][0]*z_new[0][j]+zx[i][1]*z_new[1][j]+zx[i][2]*z_new[2][j];
+	}
+}
 
-	sin_x = sin(dx);
-	cos_x = cos(dx);
-	sin_y = sin(dy);
-	cos_y = cos(dy);
-	sin_z = sin(dz);
-	cos_z = cos(dz);
+/// Function to rotate all spins of a material (or all spins for material < 0) by S' = S.R
+void rotate_spins(const double R[3][3], const int material){
 
-	std::vector< std::vector<double> > x_rotation_matrix,y_rotation_matrix,z_rotation_matrix,ref_vec;
+	for(int atom =0;atom<atoms::num_atoms;atom++){
+		if(material>=0 && atoms::type_array[atom]!=material) continue;
 
-	x_rotation_matrix=vmath::set_matrix(3,3);
-	y_rotation_matrix=vmath::set_matrix(3,3);
-	z_rotation_matrix=vmath::set_matrix(3,3);
-	ref_vec=vmath::set_matrix(1,3,reference_vector);
+		// Load spin coordinates
+		const double Sx=atoms::x_spin_array[atom];
+		const double Sy=atoms::y_spin_array[atom];
+		const double Sz=atoms::z_spin_array[atom];
 
-	
-	x_rotation_matrix[0][0] = 1.0;
-	x_rotation_matrix[1][0] = 0.0;
-	x_rotation_matrix[2][0] = 0.0;
-	x_rotation_matrix[0][1] = 0.0;
-	x_rotation_matrix[1][1] = cos_x;
-	x_rotation_matrix[2][1] = -sin_x;
-	x_rotation_matrix[0][2] = 0.0;
-	x_rotation_matrix[1][2] = sin_x;
-	x_rotation_matrix[2][2] = cos_x;
-
-	y_rotation_matrix[0][0] = cos_y;
-	y_rotation_matrix[1][0] = 0.0;
-	y_rotation_matrix[2][0] = sin_y;
-	y_rotation_matrix[0][1] = 0.0;
-	y_rotation_matrix[1][1] = 1.0;
-	y_rotation_matrix[2][1] = 0.0;
-	y_rotation_matrix[0][2] = -sin_y;
-	y_rotation_matrix[1][2] = 0.0;
-	y_rotation_matrix[2][2] = cos_y;
-
-	z_rotation_matrix[0][0] = cos_z;
-	z_rotation_matrix[1][0] = -sin_z;
-	z_rotation_matrix[2][0] = 0.0;
-	z_rotation_matrix[0][1] = sin_z;
-	z_rotation_matrix[1][1] = cos_z;
-	z_rotation_matrix[2][1] = 0.0;
-	z_rotation_matrix[0][2] = 0.0;
-	z_rotation_matrix[1][2] = 0.0;
-	z_rotation_matrix[2][2] = 1.0;
-
-	polar_matrix = vmath::matmul(y_rotation_matrix,z_rotation_matrix);
-	polar_matrix_tp = vmath::transpose(polar_matrix);
-	polar_vector = vmath::matmul(ref_vec,polar_matrix);
+		// Set new spin positions
+		atoms::x_spin_array[atom]=Sx*R[0][0]+Sy*R[1][0]+Sz*R[2][0];
+		atoms::y_spin_array[atom]=Sx*R[0][1]+Sy*R[1][1]+Sz*R[2][1];
+		atoms::z_spin_array[atom]=Sx*R[0][2]+Sy*R[1][2]+Sz*R[2][2];
+	}
 
+	return;
 }
 
 /// Function to rotate all spin around the z-axis
 void rotate_spins_around_z_axis(double ddz){
 
-	std::vector< std::vector<double> > x_rotation_matrix,y_rotation_matrix,z_rotation_matrix;
-
-	// determine rotational matrices for phi, theta rotation
-	vmath::set_rotational_matrix(0.0, 0.0, ddz, x_rotation_matrix,y_rotation_matrix,z_rotation_matrix);
+	double z_rotation_matrix[3][3];
+	set_z_rotation_matrix(ddz, z_rotation_matrix);
 
 	// loop over all spins and rotate by theta around z
-	for(int atom =0;atom<atoms::num_atoms;atom++){
-			std::vector<double> Sold(3), Snew(3); // Vectors to hold spins
-
-			// Load spin coordinates
-			Sold[0]=atoms::x_spin_array[atom];
-			Sold[1]=atoms::y_spin_array[atom];
-			Sold[2]=atoms::z_spin_array[atom];
-
-			// Calculate new spin positions
-			Snew = vmath::matmul(Sold,z_rotation_matrix);
-
-			// Set new spin positions
-			atoms::x_spin_array[atom]=Snew[0];
-			atoms::y_spin_array[atom]=Snew[1];
-			atoms::z_spin_array[atom]=Snew[2];
-		}
+	rotate_spins(z_rotation_matrix, -1);
 
 	return;
 }
@@ -202,30 +202,11 @@ void rotate_spins_around_z_axis(double ddz){
 /// Function to rotate all spin around the x-axis
 void rotate_spins_around_x_axis(double ddx){
 
-	std::vector< std::vector<double> > x_rotation_matrix,y_rotation_matrix,z_rotation_matrix;
-
-	// determine rotational matrices for phi, theta rotation
-	vmath::set_rotational_matrix(ddx, 0.0, 0.0, x_rotation_matrix,y_rotation_matrix,z_rotation_matrix);
-
-	//vmath::print_matrix(x_rotation_matrix);
+	double x_rotation_matrix[3][3];
+	set_x_rotation_matrix(ddx, x_rotation_matrix);
 
 	// loop over all spins and rotate by phi around x
-	for(int atom =0;atom<atoms::num_atoms;atom++){
-		std::vector<double> Sold(3), Snew(3); // Vectors to hold spins
-
-		// Load spin coordinates
-		Sold[0]=atoms::x_spin_array[atom];
-		Sold[1]=atoms::y_spin_array[atom];
-		Sold[2]=atoms::z_spin_array[atom];
-
-		// Calculate new spin positions
-		Snew = vmath::matmul(Sold,x_rotation_matrix);
-
-		// Set new spin positions
-		atoms::x_spin_array[atom]=Snew[0];
-		atoms::y_spin_array[atom]=Snew[1];
-		atoms::z_spin_array[atom]=Snew[2];
-	}
+	rotate_spins(x_rotation_matrix, -1);
 
 	return;
 }
@@ -285,14 +266,10 @@ void CMCinit(){
 		if(sim::constraint_theta_changed) theta_old = sim::constraint_theta - sim::constraint_theta_delta;
 		if(sim::constraint_phi_changed) phi_old     = sim::constraint_phi   - sim::constraint_phi_delta;
 
-		// Rotate all spins from theta_old to theta = 0 (reference direction along x)
-		cmc::rotate_spins_around_z_axis(-theta_old);
-
-		// Rotate all spins from phi_old to phi_new
-		cmc::rotate_spins_around_x_axis(phi_new-phi_old);
-
-		// Rotate all spins from theta = 0 to theta = theta_new
-		cmc::rotate_spins_around_z_axis(theta_new);
+		// Rotate all spins from old to new constraint direction in a single pass
+		double R[3][3];
+		cmc::set_constraint_rotation_matrix(theta_old, phi_new-phi_old, theta_new, R);
+		cmc::rotate_spins(R, -1);
 
 		// reset rotation flags
 		sim::constraint_theta_changed = false;
@@ -336,9 +313,6 @@ int ConstrainedMonteCarlo(){
 	double delta_energy2;
 	double delta_energy21;
 
-	double Eold;
-	double Enew;
-
 	std::valarray<double> spin1_initial(3);
 	std::valarray<double> spin1_final(3);
 	double spin2_initial[3];
@@ -349,11 +323,10 @@ int ConstrainedMonteCarlo(){
 	double spin2_init_mvd[3];
 	double spin2_fin_mvd[3];
 
-	double M_other[3];
+	double dM[3];
 	double Mz_old;
 	double Mz_new;
 
-	double sqrt_ran;
 	double probability;
 
    // Material dependent temperature rescaling
@@ -367,32 +340,19 @@ int ConstrainedMonteCarlo(){
       sigma_array[m] = rescaled_temperature < 1.0 ? 0.02 : pow(1.0/rescaled_material_kBTBohr[m],0.2)*0.08;
    }
 
-	// copy matrices for speed
-	double ppolar_vector[3];
-	double ppolar_matrix[3][3];
-	double ppolar_matrix_tp[3][3];
+	// local references to matrices for speed
+	const double (&ppolar_vector)[3] = cmc::polar_vector;
+	const double (&ppolar_matrix)[3][3] = cmc::polar_matrix;
+	const double (&ppolar_matrix_tp)[3][3] = cmc::polar_matrix_tp;
 	
 	const int AtomExchangeType=atoms::exchange_type;
-	
-	for (int i=0;i<3;i++){
-		ppolar_vector[i]=cmc::polar_vector[0][i];
-		for (int j=0;j<3;j++){
-			ppolar_matrix[i][j]=cmc::polar_matrix[i][j];
-			ppolar_matrix_tp[i][j]=cmc::polar_matrix_tp[i][j];
-		}
-	}
-
-	//sigma = ((kbT_bohr)**0.2)*0.08_dp
-	//inv_kbT_bohr = 1.0_dp/kbT_bohr
-
-	M_other[0] = 0.0;
-	M_other[1] = 0.0;
-	M_other[2] = 0.0;
 
+	// Total magnetisation, recalculated every step to avoid drift and then updated by accepted moves
+	double M_other[3]={0.0,0.0,0.0};
 	for(int atom=0;atom<atoms::num_atoms;atom++){
-		M_other[0] = M_other[0] + atoms::x_spin_array[atom]; //multiplied by polar_vector below
-		M_other[1] = M_other[1] + atoms::y_spin_array[atom];
-		M_other[2] = M_other[2] + atoms::z_spin_array[atom];
+		M_other[0] += atoms::x_spin_array[atom]; //multiplied by polar_vector below
+		M_other[1] += atoms::y_spin_array[atom];
+		M_other[2] += atoms::z_spin_array[atom];
 	}
 
 	for (int mcs=0;mcs<atoms::num_atoms;mcs++){ 
@@ -419,23 +379,6 @@ int ConstrainedMonteCarlo(){
 		spin1_fin_mvd[1]=ppolar_matrix[1][0]*spin1_final[0]+ppolar_matrix[1][1]*spin1_final[1]+ppolar_matrix[1][2]*spin1_final[2];
 		spin1_fin_mvd[2]=ppolar_matrix[2][0]*spin1_final[0]+ppolar_matrix[2][1]*spin1_final[1]+ppolar_matrix[2][2]*spin1_final[2];
 
-		// Calculate Energy Difference 1
-		//call calc_one_spin_energy(delta_energy1,spin1_final,atom_number1)
-
-		// Calculate current energy
-		Eold = sim::calculate_spin_energy(atom_number1, AtomExchangeType);
-			
-		// Copy new spin position (provisionally accept move)
-		atoms::x_spin_array[atom_number1] = spin1_final[0];
-		atoms::y_spin_array[atom_number1] = spin1_final[1];
-		atoms::z_spin_array[atom_number1] = spin1_final[2];
-
-		// Calculate new energy
-		Enew = sim::calculate_spin_energy(atom_number1, AtomExchangeType);
-			
-		// Calculate difference in Joules/mu_B
-		delta_energy1 = (Enew-Eold)*mp::material[imat1].mu_s_SI*1.07828231e23; //1/9.27400915e-24
-
 		// Compute second move
 
 		// Randomly select spin number 2 (i/=j)
@@ -464,67 +407,54 @@ int ConstrainedMonteCarlo(){
 			spin2_final[1]=ppolar_matrix_tp[1][0]*spin2_fin_mvd[0]+ppolar_matrix_tp[1][1]*spin2_fin_mvd[1]+ppolar_matrix_tp[1][2]*spin2_fin_mvd[2];
 			spin2_final[2]=ppolar_matrix_tp[2][0]*spin2_fin_mvd[0]+ppolar_matrix_tp[2][1]*spin2_fin_mvd[1]+ppolar_matrix_tp[2][2]*spin2_fin_mvd[2];
 
-			// Automatically accept move for Spin1 - now before if ^^
-			//atomic_spin_array(:,atom_number1) = spin1_final(:)
+			// Calculate Energy Difference 1 in Joules/mu_B
+			delta_energy1 = sim::calculate_spin_energy_difference(atom_number1, AtomExchangeType, &spin1_initial[0], &spin1_final[0])*mp::material[imat1].mu_s_SI*1.07828231e23; //1/9.27400915e-24
 
-			//Calculate Energy Difference 2
-			// Calculate current energy
-			Eold = sim::calculate_spin_energy(atom_number2, AtomExchangeType);
-			
-			// Copy new spin position (provisionally accept move)
-			atoms::x_spin_array[atom_number2] = spin2_final[0];
-			atoms::y_spin_array[atom_number2] = spin2_final[1];
-			atoms::z_spin_array[atom_number2] = spin2_final[2];
+			// Copy new spin position (provisionally accept move) so that spin 2 sees new spin 1
+			atoms::x_spin_array[atom_number1] = spin1_final[0];
+			atoms::y_spin_array[atom_number1] = spin1_final[1];
+			atoms::z_spin_array[atom_number1] = spin1_final[2];
 
-			// Calculate new energy
-			Enew = sim::calculate_spin_energy(atom_number2, AtomExchangeType);
-			
-			// Calculate difference in Joules/mu_B
-			delta_energy2 = (Enew-Eold)*mp::material[imat2].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+			// Calculate Energy Difference 2 in Joules/mu_B
+			delta_energy2 = sim::calculate_spin_energy_difference(atom_number2, AtomExchangeType, spin2_initial, spin2_final)*mp::material[imat2].mu_s_SI*1.07828231e23; //1/9.27400915e-24
 
 			// Calculate Delta E for both spins
 			delta_energy21 = delta_energy1*rescaled_material_kBTBohr[imat1] + delta_energy2*rescaled_material_kBTBohr[imat2];
 
 			// Compute Mz_other, Mz, Mz'
+			dM[0] = spin1_final[0] + spin2_final[0] - spin1_initial[0] - spin2_initial[0];
+			dM[1] = spin1_final[1] + spin2_final[1] - spin1_initial[1] - spin2_initial[1];
+			dM[2] = spin1_final[2] + spin2_final[2] - spin1_initial[2] - spin2_initial[2];
+
 			Mz_old = M_other[0]*ppolar_vector[0] + M_other[1]*ppolar_vector[1] + M_other[2]*ppolar_vector[2];
 
-			Mz_new = (M_other[0] + spin1_final[0] + spin2_final[0]- spin1_initial[0] - spin2_initial[0])*ppolar_vector[0] +
-						(M_other[1] + spin1_final[1] + spin2_final[1]- spin1_initial[1] - spin2_initial[1])*ppolar_vector[1] +
-						(M_other[2] + spin1_final[2] + spin2_final[2]- spin1_initial[2] - spin2_initial[2])*ppolar_vector[2];
-
-			// Check for lower energy state and accept unconditionally
-			//if((delta_energy21<0.0) && (Mz_new>0.0)) continue;
-			
-			// Otherwise evaluate probability for move
-			//else{
-				// If move is favorable then accept
-				probability = exp(-delta_energy21)*((Mz_new/Mz_old)*(Mz_new/Mz_old))*std::fabs(spin2_init_mvd[2]/spin2_fin_mvd[2]);
-				if((probability>=mtrandom::grnd()) && (Mz_new>0.0) ){
-					M_other[0] = M_other[0] + spin1_final[0] + spin2_final[0] - spin1_initial[0] - spin2_initial[0];
-					M_other[1] = M_other[1] + spin1_final[1] + spin2_final[1] - spin1_initial[1] - spin2_initial[1];
-					M_other[2] = M_other[2] + spin1_final[2] + spin2_final[2] - spin1_initial[2] - spin2_initial[2];
-					cmc::mc_success += 1.0;
-				}
-				//if both p1 and p2 not allowed then
-				else{ 
-					// reset spin positions
-					atoms::x_spin_array[atom_number1] = spin1_initial[0];
-					atoms::y_spin_array[atom_number1] = spin1_initial[1];
-					atoms::z_spin_array[atom_number1] = spin1_initial[2];
-
-					atoms::x_spin_array[atom_number2] = spin2_initial[0];
-					atoms::y_spin_array[atom_number2] = spin2_initial[1];
-					atoms::z_spin_array[atom_number2] = spin2_initial[2];
-
-					cmc::energy_reject += 1.0;
-				}
-			//}
+			Mz_new = (M_other[0] + dM[0])*ppolar_vector[0] +
+						(M_other[1] + dM[1])*ppolar_vector[1] +
+						(M_other[2] + dM[2])*ppolar_vector[2];
+
+			// If move is favorable then accept
+			probability = exp(-delta_energy21)*((Mz_new/Mz_old)*(Mz_new/Mz_old))*std::fabs(spin2_init_mvd[2]/spin2_fin_mvd[2]);
+			if((probability>=mtrandom::grnd()) && (Mz_new>0.0) ){
+				atoms::x_spin_array[atom_number2] = spin2_final[0];
+				atoms::y_spin_array[atom_number2] = spin2_final[1];
+				atoms::z_spin_array[atom_number2] = spin2_final[2];
+				M_other[0] += dM[0];
+				M_other[1] += dM[1];
+				M_other[2] += dM[2];
+				cmc::mc_success += 1.0;
+			}
+			//if both p1 and p2 not allowed then
+			else{ 
+				// reset spin position
+				atoms::x_spin_array[atom_number1] = spin1_initial[0];
+				atoms::y_spin_array[atom_number1] = spin1_initial[1];
+				atoms::z_spin_array[atom_number1] = spin1_initial[2];
+
+				cmc::energy_reject += 1.0;
+			}
 		}
 		// if s2 not on unit sphere
 		else{ 
-			atoms::x_spin_array[atom_number1] = spin1_initial[0];
-			atoms::y_spin_array[atom_number1] = spin1_initial[1];
-			atoms::z_spin_array[atom_number1] = spin1_initial[2];
 			cmc::sphere_reject+=1.0;
 		}
 
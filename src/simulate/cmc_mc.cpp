@@ -72,95 +72,12 @@ void mat_polar_rot_matrix()
 	
 	for(int mat=0;mat<mp::num_materials;mat++){
 		
-	const double phi=cmc::cmc_mat[mat].constraint_phi;
-	const double theta=cmc::cmc_mat[mat].constraint_theta;
-	
-	std::vector< std::vector<double> > polar_matrix; 
-	std::vector< std::vector<double> > polar_matrix_tp; 
-	std::vector< std::vector<double> > polar_vector;
-	
-	double dx,dy,dz; //change in angle in radians
-	double ddx,ddy,ddz; //change in angle in degrees
-
-	double sin_x,sin_y,sin_z,cos_x,cos_y,cos_z;
-	std::vector<double> reference_vector(3);
-
-	double pi=3.14159265358979323846264338327;
-
-	//--------------------------------------------------
-	// Initialise varibales 
-	//--------------------------------------------------
-
-	ddx = 0.0;
-	ddy = phi;
-	ddz = theta;// assumues x = cos(theta)sin(phi), y = sin(theta)sin(phi)
-
-	dx = (ddx/360.0)*2.0*pi;
-	dy = (ddy/360.0)*2.0*pi;
-	dz = (ddz/360.0)*2.0*pi;
+		const double phi=cmc::cmc_mat[mat].constraint_phi;
+		const double theta=cmc::cmc_mat[mat].constraint_theta;
 
-	reference_vector[0] = 0.0;
-	reference_vector[1] = 0.0;
-	reference_vector[2] = 1.0;
-	
-	sin_x = sin(dx);
-	cos_x = cos(dx);
-	sin_y = sin(dy);
-	cos_y = cos(dy);
-	sin_z = sin(dz);
-	cos_z = cos(dz);
-
-	std::vector< std::vector<double> > x_rotation_matrix,y_rotation_matrix,z_rotation_matrix,ref_vec;
-	
-	x_rotation_matrix=vmath::set_matrix(3,3);
-	y_rotation_matrix=vmath::set_matrix(3,3);
-	z_rotation_matrix=vmath::set_matrix(3,3);
-	ref_vec=vmath::set_matrix(1,3,reference_vector);
+		// calculate matrices directly in performance optimised class variables
+		cmc::polar_rot_matrix(phi, theta, cmc::cmc_mat[mat].ppolar_matrix, cmc::cmc_mat[mat].ppolar_matrix_tp, cmc::cmc_mat[mat].ppolar_vector);
 
-	
-	x_rotation_matrix[0][0] = 1.0;
-	x_rotation_matrix[1][0] = 0.0;
-	x_rotation_matrix[2][0] = 0.0;
-	x_rotation_matrix[0][1] = 0.0;
-	x_rotation_matrix[1][1] = cos_x;
-	x_rotation_matrix[2][1] = -sin_x;
-	x_rotation_matrix[0][2] = 0.0;
-	x_rotation_matrix[1][2] = sin_x;
-	x_rotation_matrix[2][2] = cos_x;
-
-	y_rotation_matrix[0][0] = cos_y;
-	y_rotation_matrix[1][0] = 0.0;
-	y_rotation_matrix[2][0] = sin_y;
-	y_rotation_matrix[0][1] = 0.0;
-	y_rotation_matrix[1][1] = 1.0;
-	y_rotation_matrix[2][1] = 0.0;
-	y_rotation_matrix[0][2] = -sin_y;
-	y_rotation_matrix[1][2] = 0.0;
-	y_rotation_matrix[2][2] = cos_y;
-
-	z_rotation_matrix[0][0] = cos_z;
-	z_rotation_matrix[1][0] = -sin_z;
-	z_rotation_matrix[2][0] = 0.0;
-	z_rotation_matrix[0][1] = sin_z;
-	z_rotation_matrix[1][1] = cos_z;
-	z_rotation_matrix[2][1] = 0.0;
-	z_rotation_matrix[0][2] = 0.0;
-	z_rotation_matrix[1][2] = 0.0;
-	z_rotation_matrix[2][2] = 1.0;
-
-	polar_matrix = vmath::matmul(y_rotation_matrix,z_rotation_matrix);
-	polar_matrix_tp = vmath::transpose(polar_matrix);
-	polar_vector = vmath::matmul(ref_vec,polar_matrix);
-
-	// copy matrices to performance optimised class variables
-	for (int i=0;i<3;i++){
-		cmc::cmc_mat[mat].ppolar_vector[i]=polar_vector[0][i];
-		for (int j=0;j<3;j++){
-			cmc::cmc_mat[mat].ppolar_matrix[i][j]=polar_matrix[i][j];
-			cmc::cmc_mat[mat].ppolar_matrix_tp[i][j]=polar_matrix_tp[i][j];
-		}
-	}
-	
 	} // end of loop over materials
 	
 } // end of polar rotation initialisation
@@ -168,31 +85,11 @@ void mat_polar_rot_matrix()
 /// Function to rotate all spin around the z-axis
 void rotate_material_spins_around_z_axis(double ddz, int material){
 
-	std::vector< std::vector<double> > x_rotation_matrix,y_rotation_matrix,z_rotation_matrix;
-
-	// determine rotational matrices for phi, theta rotation
-	vmath::set_rotational_matrix(0.0, 0.0, ddz, x_rotation_matrix,y_rotation_matrix,z_rotation_matrix);
+	double z_rotation_matrix[3][3];
+	cmc::set_z_rotation_matrix(ddz, z_rotation_matrix);
 
 	// loop over all spins and rotate by theta around z
-	for(int atom =0;atom<atoms::num_atoms;atom++){
-		int mat=atoms::type_array[atom];
-		if(mat==material){
-			std::vector<double> Sold(3), Snew(3); // Vectors to hold spins
-
-			// Load spin coordinates
-			Sold[0]=atoms::x_spin_array[atom];
-			Sold[1]=atoms::y_spin_array[atom];
-			Sold[2]=atoms::z_spin_array[atom];
-
-			// Calculate new spin positions
-			Snew = vmath::matmul(Sold,z_rotation_matrix);
-
-			// Set new spin positions
-			atoms::x_spin_array[atom]=Snew[0];
-			atoms::y_spin_array[atom]=Snew[1];
-			atoms::z_spin_array[atom]=Snew[2];
-		}
-	}
+	cmc::rotate_spins(z_rotation_matrix, material);
 
 	return;
 }
@@ -200,31 +97,11 @@ void rotate_material_spins_around_z_axis(double ddz, int material){
 /// Function to rotate all spin around the x-axis
 void rotate_material_spins_around_x_axis(double ddx, int material){
 
-	std::vector< std::vector<double> > x_rotation_matrix,y_rotation_matrix,z_rotation_matrix;
-
-	// determine rotational matrices for phi, theta rotation
-	vmath::set_rotational_matrix(ddx, 0.0, 0.0, x_rotation_matrix,y_rotation_matrix,z_rotation_matrix);
+	double x_rotation_matrix[3][3];
+	cmc::set_x_rotation_matrix(ddx, x_rotation_matrix);
 
 	// loop over all spins and rotate by phi around x
-	for(int atom =0;atom<atoms::num_atoms;atom++){
-		int mat=atoms::type_array[atom];
-		if(mat==material){
-			std::vector<double> Sold(3), Snew(3); // Vectors to hold spins
-
-			// Load spin coordinates
-			Sold[0]=atoms::x_spin_array[atom];
-			Sold[1]=atoms::y_spin_array[atom];
-			Sold[2]=atoms::z_spin_array[atom];
-
-			// Calculate new spin positions
-			Snew = vmath::matmul(Sold,x_rotation_matrix);
-
-			// Set new spin positions
-			atoms::x_spin_array[atom]=Snew[0];
-			atoms::y_spin_array[atom]=Snew[1];
-			atoms::z_spin_array[atom]=Snew[2];
-		}
-	}
+	cmc::rotate_spins(x_rotation_matrix, material);
 
 	return;
 }
@@ -249,6 +126,7 @@ void CMCMCinit(){
 	cmc::mat_polar_rot_matrix();
 
 	cmc::atom_list.resize(mp::num_materials);
+	for(int mat=0;mat<mp::num_materials;mat++) cmc::atom_list[mat].resize(0);
 	// create list of matching materials
 	for(int atom=0;atom<atoms::num_atoms;atom++){
 		int mat=atoms::type_array[atom];
@@ -294,14 +172,10 @@ void CMCMCinit(){
 		if(sim::constraint_theta_changed) theta_old = cmc::cmc_mat[cmc::active_material].constraint_theta - cmc::cmc_mat[cmc::active_material].constraint_theta_delta;
 		if(sim::constraint_phi_changed) phi_old     = cmc::cmc_mat[cmc::active_material].constraint_phi - cmc::cmc_mat[cmc::active_material].constraint_phi_delta;
 		
-		// Rotate all spins in active material from theta_old to theta = 0 (reference direction along x)
-		cmc::rotate_material_spins_around_z_axis(-theta_old, cmc::active_material);
-
-		// Rotate all spins in active material from phi_old to phi_new
-		cmc::rotate_material_spins_around_x_axis(phi_new-phi_old, cmc::active_material);
-
-		// Rotate all spins in active material from theta = 0 to theta = theta_new
-		cmc::rotate_material_spins_around_z_axis(theta_new, cmc::active_material);
+		// Rotate all spins in active material from old to new constraint direction in a single pass
+		double R[3][3];
+		cmc::set_constraint_rotation_matrix(theta_old, phi_new-phi_old, theta_new, R);
+		cmc::rotate_spins(R, cmc::active_material);
 
 		// reset rotation flags
 		sim::constraint_theta_changed = false;
@@ -311,7 +185,7 @@ void CMCMCinit(){
 
 	// disable thermal field calculation
 	sim::hamiltonian_simulation_flags[3]=0;
-	
+
 	// set initialised flag to true
 	cmc::is_initialised=true;
 	
@@ -344,9 +218,6 @@ int ConstrainedMonteCarloMonteCarlo(){
 	double delta_energy2;
 	double delta_energy21;
 
-	double Eold;
-	double Enew;
-
    std::valarray<double> spin1_initial(3);
 	std::valarray<double> spin1_final(3);
 	double spin2_initial[3];
@@ -357,11 +228,10 @@ int ConstrainedMonteCarloMonteCarlo(){
 	double spin2_init_mvd[3];
 	double spin2_fin_mvd[3];
 
-	double M_other[3];
+	double dM[3];
 	double Mz_old;
 	double Mz_new;
 
-	double sqrt_ran;
 	double probability;
 	
    // Material dependent temperature rescaling
@@ -377,11 +247,11 @@ int ConstrainedMonteCarloMonteCarlo(){
 
 	const int AtomExchangeType=atoms::exchange_type; // Cast as constant and pass to energy calculation for speed
 	
-	// save initial magnetisations
+	// Magnetisation of each material, recalculated every step to avoid drift and then updated by accepted moves
 	for(int mat=0;mat<mp::num_materials;mat++){
-	cmc::cmc_mat[mat].M_other[0] = 0.0;
-	cmc::cmc_mat[mat].M_other[1] = 0.0;
-	cmc::cmc_mat[mat].M_other[2] = 0.0;
+		cmc::cmc_mat[mat].M_other[0] = 0.0;
+		cmc::cmc_mat[mat].M_other[1] = 0.0;
+		cmc::cmc_mat[mat].M_other[2] = 0.0;
 	}
 	for(int atom=0;atom<atoms::num_atoms;atom++){
 		int mat=atoms::type_array[atom];
@@ -396,6 +266,8 @@ int ConstrainedMonteCarloMonteCarlo(){
 		atom_number1 = int(mtrandom::grnd()*atoms::num_atoms);
 		imat1=atoms::type_array[atom_number1];
       sim::mc_delta_angle=sigma_array[imat1];
+
+		cmc::cmc_material_t& cmat = cmc::cmc_mat[imat1];
 		
 		// check for constrained or unconstrained
 		if(mp::material[imat1].constrained==false){
@@ -409,41 +281,26 @@ int ConstrainedMonteCarloMonteCarlo(){
          // Make Monte Carlo move
          sim::mc_move(spin1_initial, spin1_final);
 
-			// Calculate current energy
-			Eold = sim::calculate_spin_energy(atom_number1, AtomExchangeType);
-			
-			// Copy new spin position
-			atoms::x_spin_array[atom_number1] = spin1_final[0];
-			atoms::y_spin_array[atom_number1] = spin1_final[1];
-			atoms::z_spin_array[atom_number1] = spin1_final[2];
-
-			// Calculate new energy
-			Enew = sim::calculate_spin_energy(atom_number1, AtomExchangeType);
-			
 			// Calculate difference in Joules/mu_B
-			delta_energy1 = (Enew-Eold)*mp::material[imat1].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+			delta_energy1 = sim::calculate_spin_energy_difference(atom_number1, AtomExchangeType, &spin1_initial[0], &spin1_final[0])*mp::material[imat1].mu_s_SI*1.07828231e23; //1/9.27400915e-24
 			
-			// Check for lower energy state and accept unconditionally
-			if(delta_energy1<0){
+			// Accept lower energy states unconditionally, otherwise evaluate probability for move
+			if(delta_energy1<0 || exp(-delta_energy1*rescaled_material_kBTBohr[imat1]) >= mtrandom::grnd()){
+				atoms::x_spin_array[atom_number1] = spin1_final[0];
+				atoms::y_spin_array[atom_number1] = spin1_final[1];
+				atoms::z_spin_array[atom_number1] = spin1_final[2];
+				cmat.M_other[0] += spin1_final[0] - spin1_initial[0];
+				cmat.M_other[1] += spin1_final[1] - spin1_initial[1];
+				cmat.M_other[2] += spin1_final[2] - spin1_initial[2];
             cmc::mc_success += 1.0;
-         }
-			// Otherwise evaluate probability for move
+			}
+			// If rejected leave spin coordinates unchanged
 			else{
-				if(exp(-delta_energy1*rescaled_material_kBTBohr[imat1]) >= mtrandom::grnd()){
-               cmc::mc_success += 1.0;
-            }
-				// If rejected reset spin coordinates and continue
-				else{
-					atoms::x_spin_array[atom_number1] = spin1_initial[0];
-					atoms::y_spin_array[atom_number1] = spin1_initial[1];
-					atoms::z_spin_array[atom_number1] = spin1_initial[2];
-               cmc::energy_reject += 1.0;
-				}
+            cmc::energy_reject += 1.0;
 			}
 		}
 		else{
 		// constrained MC move
-		const int imat=imat1;
 		
 		// Save initial Spin 1
 		spin1_initial[0] = atoms::x_spin_array[atom_number1];
@@ -451,31 +308,17 @@ int ConstrainedMonteCarloMonteCarlo(){
 		spin1_initial[2] = atoms::z_spin_array[atom_number1];
 		
 		//spin1_init_mvd = matmul(polar_matrix, spin1_initial)
-		spin1_init_mvd[0]=cmc::cmc_mat[imat].ppolar_matrix[0][0]*spin1_initial[0]+cmc::cmc_mat[imat].ppolar_matrix[0][1]*spin1_initial[1]+cmc::cmc_mat[imat].ppolar_matrix[0][2]*spin1_initial[2];
-		spin1_init_mvd[1]=cmc::cmc_mat[imat].ppolar_matrix[1][0]*spin1_initial[0]+cmc::cmc_mat[imat].ppolar_matrix[1][1]*spin1_initial[1]+cmc::cmc_mat[imat].ppolar_matrix[1][2]*spin1_initial[2];
-		spin1_init_mvd[2]=cmc::cmc_mat[imat].ppolar_matrix[2][0]*spin1_initial[0]+cmc::cmc_mat[imat].ppolar_matrix[2][1]*spin1_initial[1]+cmc::cmc_mat[imat].ppolar_matrix[2][2]*spin1_initial[2];
+		spin1_init_mvd[0]=cmat.ppolar_matrix[0][0]*spin1_initial[0]+cmat.ppolar_matrix[0][1]*spin1_initial[1]+cmat.ppolar_matrix[0][2]*spin1_initial[2];
+		spin1_init_mvd[1]=cmat.ppolar_matrix[1][0]*spin1_initial[0]+cmat.ppolar_matrix[1][1]*spin1_initial[1]+cmat.ppolar_matrix[1][2]*spin1_initial[2];
+		spin1_init_mvd[2]=cmat.ppolar_matrix[2][0]*spin1_initial[0]+cmat.ppolar_matrix[2][1]*spin1_initial[1]+cmat.ppolar_matrix[2][2]*spin1_initial[2];
 
       // Make Monte Carlo move
       sim::mc_move(spin1_initial, spin1_final);
 
 		//spin1_fin_mvd = matmul(polar_matrix, spin1_final)
-		spin1_fin_mvd[0]=cmc::cmc_mat[imat].ppolar_matrix[0][0]*spin1_final[0]+cmc::cmc_mat[imat].ppolar_matrix[0][1]*spin1_final[1]+cmc::cmc_mat[imat].ppolar_matrix[0][2]*spin1_final[2];
-		spin1_fin_mvd[1]=cmc::cmc_mat[imat].ppolar_matrix[1][0]*spin1_final[0]+cmc::cmc_mat[imat].ppolar_matrix[1][1]*spin1_final[1]+cmc::cmc_mat[imat].ppolar_matrix[1][2]*spin1_final[2];
-		spin1_fin_mvd[2]=cmc::cmc_mat[imat].ppolar_matrix[2][0]*spin1_final[0]+cmc::cmc_mat[imat].ppolar_matrix[2][1]*spin1_final[1]+cmc::cmc_mat[imat].ppolar_matrix[2][2]*spin1_final[2];
-
-		// Calculate current energy
-		Eold = sim::calculate_spin_energy(atom_number1, AtomExchangeType);
-			
-		// Copy new spin position (provisionally accept move)
-		atoms::x_spin_array[atom_number1] = spin1_final[0];
-		atoms::y_spin_array[atom_number1] = spin1_final[1];
-		atoms::z_spin_array[atom_number1] = spin1_final[2];
-
-		// Calculate new energy
-		Enew = sim::calculate_spin_energy(atom_number1, AtomExchangeType);
-			
-		// Calculate difference in Joules/mu_B
-		delta_energy1 = (Enew-Eold)*mp::material[imat1].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+		spin1_fin_mvd[0]=cmat.ppolar_matrix[0][0]*spin1_final[0]+cmat.ppolar_matrix[0][1]*spin1_final[1]+cmat.ppolar_matrix[0][2]*spin1_final[2];
+		spin1_fin_mvd[1]=cmat.ppolar_matrix[1][0]*spin1_final[0]+cmat.ppolar_matrix[1][1]*spin1_final[1]+cmat.ppolar_matrix[1][2]*spin1_final[2];
+		spin1_fin_mvd[2]=cmat.ppolar_matrix[2][0]*spin1_final[0]+cmat.ppolar_matrix[2][1]*spin1_final[1]+cmat.ppolar_matrix[2][2]*spin1_final[2];
 
 		// Compute second move
 
@@ -495,9 +338,9 @@ int ConstrainedMonteCarloMonteCarlo(){
 		spin2_initial[2] = atoms::z_spin_array[atom_number2];
 		
 		//spin2_init_mvd = matmul(polar_matrix, spin2_initial)
-		spin2_init_mvd[0]=cmc::cmc_mat[imat].ppolar_matrix[0][0]*spin2_initial[0]+cmc::cmc_mat[imat].ppolar_matrix[0][1]*spin2_initial[1]+cmc::cmc_mat[imat].ppolar_matrix[0][2]*spin2_initial[2];
-		spin2_init_mvd[1]=cmc::cmc_mat[imat].ppolar_matrix[1][0]*spin2_initial[0]+cmc::cmc_mat[imat].ppolar_matrix[1][1]*spin2_initial[1]+cmc::cmc_mat[imat].ppolar_matrix[1][2]*spin2_initial[2];
-		spin2_init_mvd[2]=cmc::cmc_mat[imat].ppolar_matrix[2][0]*spin2_initial[0]+cmc::cmc_mat[imat].ppolar_matrix[2][1]*spin2_initial[1]+cmc::cmc_mat[imat].ppolar_matrix[2][2]*spin2_initial[2];
+		spin2_init_mvd[0]=cmat.ppolar_matrix[0][0]*spin2_initial[0]+cmat.ppolar_matrix[0][1]*spin2_initial[1]+cmat.ppolar_matrix[0][2]*spin2_initial[2];
+		spin2_init_mvd[1]=cmat.ppolar_matrix[1][0]*spin2_initial[0]+cmat.ppolar_matrix[1][1]*spin2_initial[1]+cmat.ppolar_matrix[1][2]*spin2_initial[2];
+		spin2_init_mvd[2]=cmat.ppolar_matrix[2][0]*spin2_initial[0]+cmat.ppolar_matrix[2][1]*spin2_initial[1]+cmat.ppolar_matrix[2][2]*spin2_initial[2];
 
 		// Calculate new spin based on constraint Mx=My=0
 		spin2_fin_mvd[0] = spin1_init_mvd[0]+spin2_init_mvd[0]-spin1_fin_mvd[0];
@@ -508,68 +351,58 @@ int ConstrainedMonteCarloMonteCarlo(){
 			spin2_fin_mvd[2] = vmath::sign(spin2_init_mvd[2])*sqrt(1.0-spin2_fin_mvd[0]*spin2_fin_mvd[0] - spin2_fin_mvd[1]*spin2_fin_mvd[1]);
 
 			//spin2_final = matmul(polar_matrix_tp, spin2_fin_mvd)
-			spin2_final[0]=cmc::cmc_mat[imat].ppolar_matrix_tp[0][0]*spin2_fin_mvd[0]+cmc::cmc_mat[imat].ppolar_matrix_tp[0][1]*spin2_fin_mvd[1]+cmc::cmc_mat[imat].ppolar_matrix_tp[0][2]*spin2_fin_mvd[2];
-			spin2_final[1]=cmc::cmc_mat[imat].ppolar_matrix_tp[1][0]*spin2_fin_mvd[0]+cmc::cmc_mat[imat].ppolar_matrix_tp[1][1]*spin2_fin_mvd[1]+cmc::cmc_mat[imat].ppolar_matrix_tp[1][2]*spin2_fin_mvd[2];
-			spin2_final[2]=cmc::cmc_mat[imat].ppolar_matrix_tp[2][0]*spin2_fin_mvd[0]+cmc::cmc_mat[imat].ppolar_matrix_tp[2][1]*spin2_fin_mvd[1]+cmc::cmc_mat[imat].ppolar_matrix_tp[2][2]*spin2_fin_mvd[2];
+			spin2_final[0]=cmat.ppolar_matrix_tp[0][0]*spin2_fin_mvd[0]+cmat.ppolar_matrix_tp[0][1]*spin2_fin_mvd[1]+cmat.ppolar_matrix_tp[0][2]*spin2_fin_mvd[2];
+			spin2_final[1]=cmat.ppolar_matrix_tp[1][0]*spin2_fin_mvd[0]+cmat.ppolar_matrix_tp[1][1]*spin2_fin_mvd[1]+cmat.ppolar_matrix_tp[1][2]*spin2_fin_mvd[2];
+			spin2_final[2]=cmat.ppolar_matrix_tp[2][0]*spin2_fin_mvd[0]+cmat.ppolar_matrix_tp[2][1]*spin2_fin_mvd[1]+cmat.ppolar_matrix_tp[2][2]*spin2_fin_mvd[2];
 
-			//Calculate Energy Difference 2
-			// Calculate current energy
-			Eold = sim::calculate_spin_energy(atom_number2, AtomExchangeType);
+			// Calculate Energy Difference 1 in Joules/mu_B
+			delta_energy1 = sim::calculate_spin_energy_difference(atom_number1, AtomExchangeType, &spin1_initial[0], &spin1_final[0])*mp::material[imat1].mu_s_SI*1.07828231e23; //1/9.27400915e-24
 
-         // Copy new spin position (provisionally accept move)
-			atoms::x_spin_array[atom_number2] = spin2_final[0];
-			atoms::y_spin_array[atom_number2] = spin2_final[1];
-			atoms::z_spin_array[atom_number2] = spin2_final[2];
-
-			// Calculate new energy
-			Enew = sim::calculate_spin_energy(atom_number2, AtomExchangeType);
+			// Copy new spin position (provisionally accept move) so that spin 2 sees new spin 1
+			atoms::x_spin_array[atom_number1] = spin1_final[0];
+			atoms::y_spin_array[atom_number1] = spin1_final[1];
+			atoms::z_spin_array[atom_number1] = spin1_final[2];
 
-         // Calculate difference in Joules/mu_B
-			delta_energy2 = (Enew-Eold)*mp::material[imat2].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+			// Calculate Energy Difference 2 in Joules/mu_B
+			delta_energy2 = sim::calculate_spin_energy_difference(atom_number2, AtomExchangeType, spin2_initial, spin2_final)*mp::material[imat2].mu_s_SI*1.07828231e23; //1/9.27400915e-24
 
 			// Calculate Delta E for both spins
 			delta_energy21 = delta_energy1*rescaled_material_kBTBohr[imat1] + delta_energy2*rescaled_material_kBTBohr[imat2];
 
 			// Compute Mz_other, Mz, Mz'
-			Mz_old = cmc::cmc_mat[imat].M_other[0]*cmc::cmc_mat[imat].ppolar_vector[0] + cmc::cmc_mat[imat].M_other[1]*cmc::cmc_mat[imat].ppolar_vector[1] + cmc::cmc_mat[imat].M_other[2]*cmc::cmc_mat[imat].ppolar_vector[2];
-
-			Mz_new = (cmc::cmc_mat[imat].M_other[0] + spin1_final[0] + spin2_final[0]- spin1_initial[0] - spin2_initial[0])*cmc::cmc_mat[imat].ppolar_vector[0] +
-						(cmc::cmc_mat[imat].M_other[1] + spin1_final[1] + spin2_final[1]- spin1_initial[1] - spin2_initial[1])*cmc::cmc_mat[imat].ppolar_vector[1] +
-						(cmc::cmc_mat[imat].M_other[2] + spin1_final[2] + spin2_final[2]- spin1_initial[2] - spin2_initial[2])*cmc::cmc_mat[imat].ppolar_vector[2];
-
-			// Check for lower energy state and accept unconditionally
-			//if((delta_energy21<0.0) && (Mz_new>=0.0) ) continue;
-			
-			// Otherwise evaluate probability for move
-			//else{
-				// If move is favorable then accept
-				probability = exp(-delta_energy21)*((Mz_new/Mz_old)*(Mz_new/Mz_old))*std::fabs(spin2_init_mvd[2]/spin2_fin_mvd[2]);
-				if((probability>=mtrandom::grnd()) && (Mz_new>=0.0) ){
-					cmc::cmc_mat[imat].M_other[0] = cmc::cmc_mat[imat].M_other[0] + spin1_final[0] + spin2_final[0] - spin1_initial[0] - spin2_initial[0];
-					cmc::cmc_mat[imat].M_other[1] = cmc::cmc_mat[imat].M_other[1] + spin1_final[1] + spin2_final[1] - spin1_initial[1] - spin2_initial[1];
-					cmc::cmc_mat[imat].M_other[2] = cmc::cmc_mat[imat].M_other[2] + spin1_final[2] + spin2_final[2] - spin1_initial[2] - spin2_initial[2];
-					cmc::mc_success += 1.0;
-				}
-				//if both p1 and p2 not allowed then
-				else{ 
-					// reset spin positions
-					atoms::x_spin_array[atom_number1] = spin1_initial[0];
-					atoms::y_spin_array[atom_number1] = spin1_initial[1];
-					atoms::z_spin_array[atom_number1] = spin1_initial[2];
-
-					atoms::x_spin_array[atom_number2] = spin2_initial[0];
-					atoms::y_spin_array[atom_number2] = spin2_initial[1];
-					atoms::z_spin_array[atom_number2] = spin2_initial[2];
-
-					cmc::energy_reject += 1.0;
-				}
-			//}
+			dM[0] = spin1_final[0] + spin2_final[0] - spin1_initial[0] - spin2_initial[0];
+			dM[1] = spin1_final[1] + spin2_final[1] - spin1_initial[1] - spin2_initial[1];
+			dM[2] = spin1_final[2] + spin2_final[2] - spin1_initial[2] - spin2_initial[2];
+
+			Mz_old = cmat.M_other[0]*cmat.ppolar_vector[0] + cmat.M_other[1]*cmat.ppolar_vector[1] + cmat.M_other[2]*cmat.ppolar_vector[2];
+
+			Mz_new = (cmat.M_other[0] + dM[0])*cmat.ppolar_vector[0] +
+						(cmat.M_other[1] + dM[1])*cmat.ppolar_vector[1] +
+						(cmat.M_other[2] + dM[2])*cmat.ppolar_vector[2];
+
+			// If move is favorable then accept
+			probability = exp(-delta_energy21)*((Mz_new/Mz_old)*(Mz_new/Mz_old))*std::fabs(spin2_init_mvd[2]/spin2_fin_mvd[2]);
+			if((probability>=mtrandom::grnd()) && (Mz_new>=0.0) ){
+				atoms::x_spin_array[atom_number2] = spin2_final[0];
+				atoms::y_spin_array[atom_number2] = spin2_final[1];
+				atoms::z_spin_array[atom_number2] = spin2_final[2];
+				cmat.M_other[0] += dM[0];
+				cmat.M_other[1] += dM[1];
+				cmat.M_other[2] += dM[2];
+				cmc::mc_success += 1.0;
+			}
+			//if both p1 and p2 not allowed then
+			else{ 
+				// reset spin position
+				atoms::x_spin_array[atom_number1] = spin1_initial[0];
+				atoms::y_spin_array[atom_number1] = spin1_initial[1];
+				atoms::z_spin_array[atom_number1] = spin1_initial[2];
+
+				cmc::energy_reject += 1.0;
+			}
 		}
 		// if s2 not on unit sphere
 		else{ 
-			atoms::x_spin_array[atom_number1] = spin1_initial[0];
-			atoms::y_spin_array[atom_number1] = spin1_initial[1];
-			atoms::z_spin_array[atom_number1] = spin1_initial[2];
 			cmc::sphere_reject+=1.0;
 		}
 		} // end of cmc move
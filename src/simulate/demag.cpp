@@ -52,6 +52,9 @@
 ///       rij_matrix[4] = yz = zy
 ///       rij_matrix[5] = zz
 ///
+///   For the regular macrocell grid the matrix depends only on the offset between cells, and
+///   with demag::compressed=true a single matrix is stored for each unique offset.
+///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
 /// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2010. All Rights Reserved.
@@ -67,6 +70,7 @@
 ///
 #include "atoms.hpp"
 #include "cells.hpp"
+#include "create.hpp"
 #include "material.hpp"
 #include "errors.hpp"
 #include "demag.hpp"
@@ -75,19 +79,38 @@
 #include "vmpi.hpp"
 
 
+#include <algorithm>
 #include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
 #include <time.h>
 
 namespace demag{
 
 	bool fast=false;
+	bool compressed=false;
 	
 	int update_rate=100; /// timesteps between updates
-	int update_time=-1; /// last update time
+	uint64_t update_time=~uint64_t(0); /// last update time (none initially)
 
 	const double prefactor=1.0e+23; // 1e-7/1e30
 
+	// Adaptive update of fields driven by change in cell magnetisation
+	double update_tolerance=0.0; /// relative change in cell magnetisation triggering update (0 = disabled)
+	int maximum_update_interval=1000; /// maximum timesteps between full updates
+	double partial_update_fraction=0.1; /// maximum fraction of changed cells for partial update
+	uint64_t last_full_update_time=0; /// time of last full update
+	std::vector <int> changed_cell_array; /// global IDs of cells exceeding tolerance
+
+	// Statistics for adaptive updates
+	double statistics_checks=0.0;
+	double statistics_full_updates=0.0;
+	double statistics_partial_updates=0.0;
+
 	std::vector <std::vector < double > > rij_xx;
 	std::vector <std::vector < double > > rij_xy;
 	std::vector <std::vector < double > > rij_xz;
@@ -95,7 +118,363 @@ namespace demag{
 	std::vector <std::vector < double > > rij_yy;
 	std::vector <std::vector < double > > rij_yz;
 	std::vector <std::vector < double > > rij_zz;
-	
+
+	// Compressed storage indexed by cell offset for regular macrocell grid
+	int offset_dimensions[3];
+	std::vector <double> offset_rij_xx;
+	std::vector <double> offset_rij_xy;
+	std::vector <double> offset_rij_xz;
+	std::vector <double> offset_rij_yy;
+	std::vector <double> offset_rij_yz;
+	std::vector <double> offset_rij_zz;
+	std::vector <int> occupied_cell_array; /// global IDs of non-empty cells
+
+	// Cache of precalculated matrices on disk
+	bool cache=false;
+	const uint64_t cache_identifier=0x5644454d41474331ULL; /// identifies vampire demag cache files
+
+	// Work arrays for symmetric direct summation
+	const int block_size=64; /// cells per block for cache reuse
+	std::vector <int> nonlocal_cell_array; /// global IDs of cells not on local CPU
+	std::vector <double> local_coord_array; /// coordinates of local cells [3*lc+i]
+	std::vector <double> local_mag_array; /// magnetisation of local cells [3*lc+i]
+	std::vector <double> local_field_array; /// accumulated field of local cells [3*lc+i]
+
+/// @brief Function to calculate hash identifying precalculated r_ij matrices
+///
+/// @details Uses the 64 bit FNV-1a hash of the bytes of all quantities the
+///          matrices depend on, so that any change in geometry or method
+///          results in a different cache file.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    18/04/2012
+///
+/// @internal
+///	Created:		18/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+inline void hash_bytes(uint64_t& hash, const void* data, const size_t num_bytes){
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	for(size_t b=0;b<num_bytes;b++){
+		hash ^= uint64_t(bytes[b]);
+		hash *= 1099511628211ULL;
+	}
+}
+
+uint64_t cache_hash(){
+
+	uint64_t hash = 14695981039346656037ULL;
+
+	// method, compressed matrices are identical on all CPUs
+	const int method = demag::compressed ? 2 : 1;
+	hash_bytes(hash, &method, sizeof(int));
+	hash_bytes(hash, &demag::prefactor, sizeof(double));
+	hash_bytes(hash, &cells::size, sizeof(double));
+	hash_bytes(hash, &demag::newell, sizeof(bool));
+	hash_bytes(hash, &demag::newell_cutoff, sizeof(double));
+	hash_bytes(hash, &demag::periodic, sizeof(bool));
+	hash_bytes(hash, &demag::periodic_images, sizeof(int));
+	hash_bytes(hash, &cs::pbc[0], 3*sizeof(bool));
+	hash_bytes(hash, &cs::system_dimensions[0], 3*sizeof(double));
+
+	// geometry
+	const int n[4]={cells::num_cells,cells::num_cells_x,cells::num_cells_y,cells::num_cells_z};
+	hash_bytes(hash, &n[0], 4*sizeof(int));
+	if(cells::num_cells>0){
+		hash_bytes(hash, &cells::x_coord_array[0], cells::num_cells*sizeof(double));
+		hash_bytes(hash, &cells::y_coord_array[0], cells::num_cells*sizeof(double));
+		hash_bytes(hash, &cells::z_coord_array[0], cells::num_cells*sizeof(double));
+		hash_bytes(hash, &cells::volume_array[0], cells::num_cells*sizeof(double));
+	}
+
+	// rows of dense matrix stored on this CPU
+	if(demag::compressed==false){
+		hash_bytes(hash, &cells::num_local_cells, sizeof(int));
+		if(cells::num_local_cells>0) hash_bytes(hash, &cells::local_cell_array[0], cells::num_local_cells*sizeof(int));
+	}
+
+	return hash;
+
+}
+
+/// @brief Function to determine file name of cache for precalculated r_ij matrices
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    18/04/2012
+///
+/// @internal
+///	Created:		18/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+std::string cache_filename(const uint64_t hash){
+	std::stringstream filename;
+	filename << "demag-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".cache";
+	return filename.str();
+}
+
+/// @brief Function to read precalculated r_ij matrices from cache file
+///
+/// @details The file contains an identifier, the hash of the calculation, the
+///          number of values per component and the six tensor components.
+///          Returns false if no valid cache exists, in which case the
+///          matrices must be calculated.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    18/04/2012
+///
+/// @internal
+///	Created:		18/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+bool load_cache(){
+
+	const uint64_t hash = cache_hash();
+	const std::string filename = cache_filename(hash);
+
+	std::ifstream cachefile;
+	cachefile.open(filename.c_str(),std::ios::binary);
+	if(!cachefile.is_open()) return false;
+
+	// check header
+	uint64_t header[3]={0,0,0};
+	cachefile.read((char*)&header[0],3*sizeof(uint64_t));
+
+	const uint64_t num_values = demag::compressed ? uint64_t(offset_rij_xx.size()) : uint64_t(cells::num_local_cells)*uint64_t(cells::num_cells);
+	if(!cachefile.good() || header[0]!=cache_identifier || header[1]!=hash || header[2]!=num_values){
+		zlog << zTs() << "Warning - demag cache file " << filename << " is invalid and will be recalculated" << std::endl;
+		return false;
+	}
+
+	// read components
+	if(demag::compressed){
+		std::vector<double>* components[6]={&offset_rij_xx,&offset_rij_xy,&offset_rij_xz,&offset_rij_yy,&offset_rij_yz,&offset_rij_zz};
+		for(int c=0;c<6;c++) cachefile.read((char*)&(*components[c])[0],sizeof(double)*num_values);
+	}
+	else{
+		std::vector <std::vector < double > >* components[6]={&rij_xx,&rij_xy,&rij_xz,&rij_yy,&rij_yz,&rij_zz};
+		for(int c=0;c<6;c++){
+			for(int lc=0;lc<cells::num_local_cells;lc++) cachefile.read((char*)&(*components[c])[lc][0],sizeof(double)*cells::num_cells);
+		}
+	}
+
+	if(!cachefile.good()){
+		zlog << zTs() << "Warning - demag cache file " << filename << " is incomplete and will be recalculated" << std::endl;
+		return false;
+	}
+
+	zlog << zTs() << "Precalculated rij matrix for demag calculation read from cache file " << filename << std::endl;
+
+	return true;
+
+}
+
+/// @brief Function to write precalculated r_ij matrices to cache file
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    18/04/2012
+///
+/// @internal
+///	Created:		18/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void save_cache(){
+
+	// compressed matrices are identical on all CPUs
+	if(demag::compressed==true && vmpi::my_rank!=0) return;
+
+	const uint64_t hash = cache_hash();
+	const std::string filename = cache_filename(hash);
+
+	std::ofstream cachefile;
+	cachefile.open(filename.c_str(),std::ios::binary);
+
+	// cache is optional, so continue without
+	if(!cachefile.is_open()){
+		zlog << zTs() << "Warning - unable to open demag cache file " << filename << " for writing" << std::endl;
+		return;
+	}
+
+	const uint64_t num_values = demag::compressed ? uint64_t(offset_rij_xx.size()) : uint64_t(cells::num_local_cells)*uint64_t(cells::num_cells);
+	const uint64_t header[3]={cache_identifier,hash,num_values};
+	cachefile.write(reinterpret_cast<const char*>(&header[0]),3*sizeof(uint64_t));
+
+	if(demag::compressed){
+		const std::vector<double>* components[6]={&offset_rij_xx,&offset_rij_xy,&offset_rij_xz,&offset_rij_yy,&offset_rij_yz,&offset_rij_zz};
+		for(int c=0;c<6;c++) cachefile.write(reinterpret_cast<const char*>(&(*components[c])[0]),sizeof(double)*num_values);
+	}
+	else{
+		const std::vector <std::vector < double > >* components[6]={&rij_xx,&rij_xy,&rij_xz,&rij_yy,&rij_yz,&rij_zz};
+		for(int c=0;c<6;c++){
+			for(int lc=0;lc<cells::num_local_cells;lc++) cachefile.write(reinterpret_cast<const char*>(&(*components[c])[lc][0]),sizeof(double)*cells::num_cells);
+		}
+	}
+
+	cachefile.close();
+
+	zlog << zTs() << "Precalculated rij matrix for demag calculation written to cache file " << filename << std::endl;
+
+	return;
+
+}
+
+/// @brief Function to set compressed r_ij matrix values
+///
+/// @details For a regular grid of macrocells the interaction depends only on
+///          the offset between cells, so one tensor per unique offset is
+///          stored, (2nx-1)(2ny-1)(2nz-1) entries in place of a dense row
+///          for every local cell. Cells are placed at the centres of the
+///          grid. The self term depends on the volume of each cell and is
+///          added in fast_update, and empty cells are skipped.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    02/04/2012
+///
+/// @internal
+///	Created:		02/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void compressed_init(){
+
+	const int n[3]={cells::num_cells_x,cells::num_cells_y,cells::num_cells_z};
+	for(int i=0;i<3;i++) offset_dimensions[i]=2*n[i]-1;
+	const int num_offsets=offset_dimensions[0]*offset_dimensions[1]*offset_dimensions[2];
+
+	// Check memory requirements and print to screen
+	zlog << zTs() << "Fast demagnetisation field calculation with compressed storage has been enabled and requires " << double(num_offsets*6)*8.0/1.0e6 << " MB of RAM" << std::endl;
+	std::cout << "Fast demagnetisation field calculation with compressed storage has been enabled and requires " << double(num_offsets*6)*8.0/1.0e6 << " MB of RAM" << std::endl;
+
+	offset_rij_xx.assign(num_offsets,0.0);
+	offset_rij_xy.assign(num_offsets,0.0);
+	offset_rij_xz.assign(num_offsets,0.0);
+	offset_rij_yy.assign(num_offsets,0.0);
+	offset_rij_yz.assign(num_offsets,0.0);
+	offset_rij_zz.assign(num_offsets,0.0);
+
+	// Read matrices from cache if available
+	const bool cached = (demag::cache==true && load_cache()==true);
+
+	if(cached==false){
+		for(int i=1-n[0];i<n[0];i++){
+			for(int j=1-n[1];j<n[1];j++){
+				for(int k=1-n[2];k<n[2];k++){
+
+					// cell interacts with its own images for periodic systems
+					if(i==0 && j==0 && k==0 && demag::periodic==false) continue;
+
+					const double rx = double(i)*cells::size; // Angstroms
+					const double ry = double(j)*cells::size;
+					const double rz = double(k)*cells::size;
+
+					double rij[6];
+					demag::interaction_tensor(rx, ry, rz, rij);
+
+					const int id = ((i+n[0]-1)*offset_dimensions[1] + j+n[1]-1)*offset_dimensions[2] + k+n[2]-1;
+
+					offset_rij_xx[id] = rij[0];
+					offset_rij_xy[id] = rij[1];
+					offset_rij_xz[id] = rij[2];
+
+					offset_rij_yy[id] = rij[3];
+					offset_rij_yz[id] = rij[4];
+					offset_rij_zz[id] = rij[5];
+
+				}
+			}
+		}
+
+		if(demag::cache==true) save_cache();
+	}
+
+	// Determine occupied cells on all CPUs
+	occupied_cell_array.resize(0);
+	for(int cell=0;cell<cells::num_cells;cell++) if(cells::volume_array[cell]>0.0) occupied_cell_array.push_back(cell);
+
+	return;
+
+}
+
+/// @brief Function to initialise work arrays for standard update method
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    12/04/2012
+///
+/// @internal
+///	Created:		12/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void std_init(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::std_init has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	// Determine cells which are not local to this CPU
+	std::vector<bool> local(cells::num_cells,false);
+	for(int lc=0;lc<cells::num_local_cells;lc++) local[cells::local_cell_array[lc]]=true;
+
+	nonlocal_cell_array.resize(0);
+	for(int cell=0;cell<cells::num_cells;cell++) if(local[cell]==false) nonlocal_cell_array.push_back(cell);
+
+	// Store local cell coordinates contiguously
+	local_coord_array.resize(3*cells::num_local_cells);
+	local_mag_array.resize(3*cells::num_local_cells);
+	local_field_array.resize(3*cells::num_local_cells);
+	for(int lc=0;lc<cells::num_local_cells;lc++){
+		const int i = cells::local_cell_array[lc];
+		local_coord_array[3*lc+0]=cells::x_coord_array[i];
+		local_coord_array[3*lc+1]=cells::y_coord_array[i];
+		local_coord_array[3*lc+2]=cells::z_coord_array[i];
+	}
+
+	return;
+
+}
+
 /// @brief Function to set r_ij matrix values
 ///
 /// @section License
@@ -123,7 +502,12 @@ void init(){
 		std::cerr << "demag::set_rij_matrix has been called " << vmpi::my_rank << std::endl;
 		terminaltextcolor(WHITE);
 	}
-	if(demag::fast==true) {
+	// set up periodic images before calculating interactions
+	demag::periodic_init();
+
+	if(demag::atomistic==true) demag::atomistic_init();
+	else if(demag::fast==true && demag::compressed==true) demag::compressed_init();
+	else if(demag::fast==true) {
 		
       // timing function
       #ifdef MPICF
@@ -159,42 +543,43 @@ void init(){
 
 		}
 
+		// Read matrices from cache if available
+		const bool cached = (demag::cache==true && load_cache()==true);
+
 		// calculate matrix prefactors
-		zlog << zTs() << "Precalculating rij matrix for demag calculation... " << std::endl;
+		if(cached==false) zlog << zTs() << "Precalculating rij matrix for demag calculation... " << std::endl;
 		
 		// loop over local cells
-		for(int lc=0;lc<cells::num_local_cells;lc++){
+		for(int lc=0;lc<cells::num_local_cells && cached==false;lc++){
 			
 			// reference global cell ID
 			int i = cells::local_cell_array[lc];
 			
 			// Loop over all other cells to calculate contribution to local cell 
 			for(int j=0;j<cells::num_cells;j++){
-				if(i!=j){
+				// cell interacts with its own images for periodic systems
+				if(i!=j || demag::periodic==true){
 				
 					const double rx = cells::x_coord_array[j]-cells::x_coord_array[i]; // Angstroms
 					const double ry = cells::y_coord_array[j]-cells::y_coord_array[i];
 					const double rz = cells::z_coord_array[j]-cells::z_coord_array[i];
 
-					const double rij = 1.0/sqrt(rx*rx+ry*ry+rz*rz);
-					
-					const double ex = rx*rij;
-					const double ey = ry*rij;
-					const double ez = rz*rij;
-
-					const double rij3 = rij*rij*rij; // Angstroms
+					double rij[6];
+					demag::interaction_tensor(rx, ry, rz, rij);
 
-					rij_xx[lc][j] = demag::prefactor*((3.0*ex*ex - 1.0)*rij3);
-					rij_xy[lc][j] = demag::prefactor*(3.0*ex*ey)*rij3;
-					rij_xz[lc][j] = demag::prefactor*(3.0*ex*ez)*rij3;
+					rij_xx[lc][j] = rij[0];
+					rij_xy[lc][j] = rij[1];
+					rij_xz[lc][j] = rij[2];
 
-					rij_yy[lc][j] = demag::prefactor*((3.0*ey*ey - 1.0)*rij3);
-					rij_yz[lc][j] = demag::prefactor*(3.0*ey*ez)*rij3;
-					rij_zz[lc][j] = demag::prefactor*((3.0*ez*ez - 1.0)*rij3);
+					rij_yy[lc][j] = rij[3];
+					rij_yz[lc][j] = rij[4];
+					rij_zz[lc][j] = rij[5];
 
 				}
 			}
 		}
+
+		if(demag::cache==true && cached==false) save_cache();
 		
       #ifdef MPICF
          double t2 = MPI_Wtime();
@@ -205,6 +590,14 @@ void init(){
 		zlog << zTs() << "Precalculation of rij matrix for demag calculation complete. Time taken: " << t2-t1 << "s."<< std::endl;
 		
 	}
+	else if(demag::fft==true) demag::fft_init();
+	else if(demag::tree==true) demag::tree_init();
+	else demag::std_init();
+
+	// cuboid tensor only used by methods with precalculated interactions
+	if(demag::newell==true && demag::fast==false && demag::fft==false){
+		zlog << zTs() << "Warning - cuboid dipole fields are only used with fast or FFT demagnetisation field calculation" << std::endl;
+	}
 	
 	// timing function
    #ifdef MPICF
@@ -292,22 +685,102 @@ inline void fast_update(){
 	//err::vexit();
 }
 
+/// @brief Function to recalculate demag fields using compressed fast update method
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    02/04/2012
+///
+/// @internal
+///	Created:		02/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+inline void compressed_update(){
+
+	// check for callin of routine
+	if(err::check==true) {
+		terminaltextcolor(RED);
+		std::cerr << "demag::compressed_update has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	const int nyz = cells::num_cells_y*cells::num_cells_z;
+	const int nz = cells::num_cells_z;
+
+	// offset of zero displacement in compressed arrays
+	const int origin = ((cells::num_cells_x-1)*offset_dimensions[1] + cells::num_cells_y-1)*offset_dimensions[2] + cells::num_cells_z-1;
+
+	const int num_occupied_cells = occupied_cell_array.size();
+
+	// loop over local cells
+	for(int lc=0;lc<cells::num_local_cells;lc++){
+
+		int i = cells::local_cell_array[lc];
+		const int ix = i/nyz;
+		const int iy = (i/nz)%cells::num_cells_y;
+		const int iz = i%nz;
+
+		// Calculate inverse volume from number of atoms in macrocell
+		// V in A^3 == 1e-30 m3, mu_0 = 4pie-7 -> prefactor = pi*4e23/3V
+		const double mu0_three_cell_volume = -4.0e23*M_PI/(3.0*cells::volume_array[i]);
+
+		// Add self-demagnetisation
+		double hx=mu0_three_cell_volume*cells::x_mag_array[i];
+		double hy=mu0_three_cell_volume*cells::y_mag_array[i];
+		double hz=mu0_three_cell_volume*cells::z_mag_array[i];
+
+		// Loop over all other occupied cells to calculate contribution to local cell
+		for(int oc=0;oc<num_occupied_cells;oc++){
+
+			const int j = occupied_cell_array[oc];
+			const int id = origin + ((j/nyz-ix)*offset_dimensions[1] + (j/nz)%cells::num_cells_y-iy)*offset_dimensions[2] + j%nz-iz;
+
+			const double mx = cells::x_mag_array[j];
+			const double my = cells::y_mag_array[j];
+			const double mz = cells::z_mag_array[j];
+
+			hx+=(mx*offset_rij_xx[id] + my*offset_rij_xy[id] + mz*offset_rij_xz[id]);
+			hy+=(mx*offset_rij_xy[id] + my*offset_rij_yy[id] + mz*offset_rij_yz[id]);
+			hz+=(mx*offset_rij_xz[id] + my*offset_rij_yz[id] + mz*offset_rij_zz[id]);
+
+		}
+
+		cells::x_field_array[i]=hx;
+		cells::y_field_array[i]=hy;
+		cells::z_field_array[i]=hz;
+
+	}
+
+}
+
 /// @brief Function to recalculate demag fields using standard update method
 ///
+/// @details Each pair of local cells is evaluated once and the field added
+///          to both cells, since the dipole tensor is symmetric and even in
+///          r_ij. Cells on other CPUs only contribute to local cells. Pairs
+///          are evaluated in blocks of cells so that the coordinates and
+///          magnetisations of each block remain in cache.
+///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
 /// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2011. All Rights Reserved.
 ///
 /// @section Information
 /// @author  Richard Evans, richard.evans@york.ac.uk
-/// @version 1.0
-/// @date    28/03/2011
+/// @version 1.1
+/// @date    12/04/2012
 ///
 /// @return EXIT_SUCCESS
 /// 
 /// @internal
 ///	Created:		28/03/2011
-///	Revision:	  ---
+///	Revision:	  12/04/2012 Symmetric pair evaluation
 ///=====================================================================================
 ///
 inline void std_update(){
@@ -318,85 +791,251 @@ inline void std_update(){
 		std::cerr << "demag::std_update has been called " << vmpi::my_rank << std::endl;
 		terminaltextcolor(WHITE);
 	}
+
+	const int num_local_cells=cells::num_local_cells;
+	const int num_nonlocal_cells=nonlocal_cell_array.size();
+
+	if(num_local_cells==0) return;
+
+	// Copy local cell magnetisations and zero field
+	for(int lc=0;lc<num_local_cells;lc++){
+		const int i = cells::local_cell_array[lc];
+		local_mag_array[3*lc+0]=cells::x_mag_array[i];
+		local_mag_array[3*lc+1]=cells::y_mag_array[i];
+		local_mag_array[3*lc+2]=cells::z_mag_array[i];
+		local_field_array[3*lc+0]=0.0;
+		local_field_array[3*lc+1]=0.0;
+		local_field_array[3*lc+2]=0.0;
+	}
+
+	const double* const r = &local_coord_array[0];
+	const double* const m = &local_mag_array[0];
+	double* const h = &local_field_array[0];
+
+	// loop over blocks of local cells
+	for(int ib=0;ib<num_local_cells;ib+=block_size){
+		const int ie = std::min(ib+block_size,num_local_cells);
+
+		// Pairs of local cells, evaluating each pair once
+		for(int jb=ib;jb<num_local_cells;jb+=block_size){
+			const int je = std::min(jb+block_size,num_local_cells);
+
+			for(int li=ib;li<ie;li++){
+
+				const double mix = m[3*li+0];
+				const double miy = m[3*li+1];
+				const double miz = m[3*li+2];
+
+				double hx=0.0;
+				double hy=0.0;
+				double hz=0.0;
+
+				for(int lj=(jb==ib ? li+1 : jb);lj<je;lj++){
+
+					const double mjx = m[3*lj+0];
+					const double mjy = m[3*lj+1];
+					const double mjz = m[3*lj+2];
+
+					const double dx = r[3*lj+0]-r[3*li+0];
+					const double dy = r[3*lj+1]-r[3*li+1];
+					const double dz = r[3*lj+2]-r[3*li+2];
+
+					const double drij = 1.0/sqrt(dx*dx+dy*dy+dz*dz);
+					const double drij3 = drij*drij*drij; // Angstroms
+
+					const double ex = dx*drij;
+					const double ey = dy*drij;
+					const double ez = dz*drij;
+
+					// field at i due to j
+					const double sj_dot_e = (mjx * ex + mjy * ey + mjz * ez);
+					hx+=(3.0 * sj_dot_e * ex - mjx)*drij3;
+					hy+=(3.0 * sj_dot_e * ey - mjy)*drij3;
+					hz+=(3.0 * sj_dot_e * ez - mjz)*drij3;
+
+					// field at j due to i
+					const double si_dot_e = (mix * ex + miy * ey + miz * ez);
+					h[3*lj+0]+=(3.0 * si_dot_e * ex - mix)*drij3;
+					h[3*lj+1]+=(3.0 * si_dot_e * ey - miy)*drij3;
+					h[3*lj+2]+=(3.0 * si_dot_e * ez - miz)*drij3;
+
+				}
+
+				h[3*li+0]+=hx;
+				h[3*li+1]+=hy;
+				h[3*li+2]+=hz;
+
+			}
+		}
+
+		// Cells on other CPUs
+		for(int jb=0;jb<num_nonlocal_cells;jb+=block_size){
+			const int je = std::min(jb+block_size,num_nonlocal_cells);
+
+			for(int li=ib;li<ie;li++){
+
+				double hx=0.0;
+				double hy=0.0;
+				double hz=0.0;
+
+				for(int nj=jb;nj<je;nj++){
+
+					const int j = nonlocal_cell_array[nj];
+
+					const double mx = cells::x_mag_array[j];
+					const double my = cells::y_mag_array[j];
+					const double mz = cells::z_mag_array[j];
+
+					const double dx = cells::x_coord_array[j]-r[3*li+0];
+					const double dy = cells::y_coord_array[j]-r[3*li+1];
+					const double dz = cells::z_coord_array[j]-r[3*li+2];
+
+					const double drij = 1.0/sqrt(dx*dx+dy*dy+dz*dz);
+					const double drij3 = drij*drij*drij; // Angstroms
+
+					const double ex = dx*drij;
+					const double ey = dy*drij;
+					const double ez = dz*drij;
+
+					const double s_dot_e = (mx * ex + my * ey + mz * ez);
+
+					hx+=(3.0 * s_dot_e * ex - mx)*drij3;
+					hy+=(3.0 * s_dot_e * ey - my)*drij3;
+					hz+=(3.0 * s_dot_e * ez - mz)*drij3;
+
+				}
+
+				h[3*li+0]+=hx;
+				h[3*li+1]+=hy;
+				h[3*li+2]+=hz;
+
+			}
+		}
+	}
+
 	// loop over local cells
-	for(int lc=0;lc<cells::num_local_cells;lc++){
+	for(int lc=0;lc<num_local_cells;lc++){
 		
 		// get global cell ID
-		int i = cells::local_cell_array[lc];
+		const int i = cells::local_cell_array[lc];
 
-      // Calculate inverse volume from number of atoms in macrocell
-      // V in A^3 == 1e-30 m3, mu_0 = 4pie-7 -> prefactor = pi*4e23/3V
-      // But multiplied out at the end -> prefactor = pi*4/3V
-      const double mu0_three_cell_volume = -4.0*M_PI/(3.0*cells::volume_array[i]);
+		// Calculate inverse volume from number of atoms in macrocell
+		// V in A^3 == 1e-30 m3, mu_0 = 4pie-7 -> prefactor = pi*4e23/3V
+		// But multiplied out at the end -> prefactor = pi*4/3V
+		const double mu0_three_cell_volume = -4.0*M_PI/(3.0*cells::volume_array[i]);
 
-      // Add self-demagnetisation
-		cells::x_field_array[i]=mu0_three_cell_volume*cells::x_mag_array[i];
-		cells::y_field_array[i]=mu0_three_cell_volume*cells::y_mag_array[i];
-		cells::z_field_array[i]=mu0_three_cell_volume*cells::z_mag_array[i];
-		
-		// Loop over all other cells to calculate contribution to local cell 
-		for(int j=0;j<i;j++){
-				
-			const double mx = cells::x_mag_array[j];
-			const double my = cells::y_mag_array[j];
-			const double mz = cells::z_mag_array[j];
+		// Add self-demagnetisation
+		cells::x_field_array[i]=demag::prefactor*(mu0_three_cell_volume*cells::x_mag_array[i] + h[3*lc+0]);
+		cells::y_field_array[i]=demag::prefactor*(mu0_three_cell_volume*cells::y_mag_array[i] + h[3*lc+1]);
+		cells::z_field_array[i]=demag::prefactor*(mu0_three_cell_volume*cells::z_mag_array[i] + h[3*lc+2]);
 
-			const double dx = cells::x_coord_array[j]-cells::x_coord_array[i];
-			const double dy = cells::y_coord_array[j]-cells::y_coord_array[i];
-			const double dz = cells::z_coord_array[j]-cells::z_coord_array[i];
+	}
+
+}
 
-			const double drij = 1.0/sqrt(dx*dx+dy*dy+dz*dz);
-			const double drij3 = drij*drij*drij; // Angstroms
+/// @brief Function to update demag fields from changed cells only
+///
+/// @details Fields are linear in the cell magnetisation, so the field due to
+///          the change in magnetisation of cells in changed_cell_array since
+///          their last update is added to the current fields. Cells below the
+///          tolerance keep their previous magnetisation until they exceed it.
+///          Uses the same point dipole tensor as the standard and fast
+///          update methods.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    14/04/2012
+///
+/// @internal
+///	Created:		14/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+inline void partial_update(){
+
+	// check for callin of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::partial_update has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
 
-			const double ex = dx*drij;
-			const double ey = dy*drij;
-			const double ez = dz*drij;
+	const int num_changed_cells=changed_cell_array.size();
 
-			const double s_dot_e = (mx * ex + my * ey + mz * ez);
+	// loop over local cells
+	for(int lc=0;lc<cells::num_local_cells;lc++){
 
-			cells::x_field_array[i]+=(3.0 * s_dot_e * ex - mx)*drij3;
-			cells::y_field_array[i]+=(3.0 * s_dot_e * ey - my)*drij3;
-			cells::z_field_array[i]+=(3.0 * s_dot_e * ez - mz)*drij3;
+		const int i = cells::local_cell_array[lc];
 
-		}
+		double hx=0.0;
+		double hy=0.0;
+		double hz=0.0;
 
-		for(int j=i+1;j<cells::num_cells;j++){
+		for(int c=0;c<num_changed_cells;c++){
 
-			const double mx = cells::x_mag_array[j];
-			const double my = cells::y_mag_array[j];
-			const double mz = cells::z_mag_array[j];
+			const int j = changed_cell_array[c];
 
-			const double dx = cells::x_coord_array[j]-cells::x_coord_array[i];
-			const double dy = cells::y_coord_array[j]-cells::y_coord_array[i];
-			const double dz = cells::z_coord_array[j]-cells::z_coord_array[i];
+			const double mx = cells::x_mag_array[j]-cells::x_mag_update_array[j];
+			const double my = cells::y_mag_array[j]-cells::y_mag_update_array[j];
+			const double mz = cells::z_mag_array[j]-cells::z_mag_update_array[j];
 
-			const double drij = 1.0/sqrt(dx*dx+dy*dy+dz*dz);
-			const double drij3 = drij*drij*drij;
+			// Self-demagnetisation
+			if(i==j){
+				const double mu0_three_cell_volume = -4.0*M_PI/(3.0*cells::volume_array[i]);
+				hx+=mu0_three_cell_volume*mx;
+				hy+=mu0_three_cell_volume*my;
+				hz+=mu0_three_cell_volume*mz;
+				// images of cell acting on itself for periodic systems
+				if(demag::fast==true && demag::periodic==true){
+					hx+=(mx*rij_xx[lc][j] + my*rij_xy[lc][j] + mz*rij_xz[lc][j])/demag::prefactor;
+					hy+=(mx*rij_xy[lc][j] + my*rij_yy[lc][j] + mz*rij_yz[lc][j])/demag::prefactor;
+					hz+=(mx*rij_xz[lc][j] + my*rij_yz[lc][j] + mz*rij_zz[lc][j])/demag::prefactor;
+				}
+			}
+			else if(demag::fast==true){
+				hx+=(mx*rij_xx[lc][j] + my*rij_xy[lc][j] + mz*rij_xz[lc][j])/demag::prefactor;
+				hy+=(mx*rij_xy[lc][j] + my*rij_yy[lc][j] + mz*rij_yz[lc][j])/demag::prefactor;
+				hz+=(mx*rij_xz[lc][j] + my*rij_yz[lc][j] + mz*rij_zz[lc][j])/demag::prefactor;
+			}
+			else{
+				const double dx = cells::x_coord_array[j]-cells::x_coord_array[i];
+				const double dy = cells::y_coord_array[j]-cells::y_coord_array[i];
+				const double dz = cells::z_coord_array[j]-cells::z_coord_array[i];
 
-			const double ex = dx*drij;
-			const double ey = dy*drij;
-			const double ez = dz*drij;
+				const double drij = 1.0/sqrt(dx*dx+dy*dy+dz*dz);
+				const double drij3 = drij*drij*drij; // Angstroms
 
-			const double s_dot_e = (mx * ex + my * ey + mz * ez);
+				const double ex = dx*drij;
+				const double ey = dy*drij;
+				const double ez = dz*drij;
 
-			cells::x_field_array[i]+=(3.0 * s_dot_e * ex - mx)*drij3;
-			cells::y_field_array[i]+=(3.0 * s_dot_e * ey - my)*drij3;
-			cells::z_field_array[i]+=(3.0 * s_dot_e * ez - mz)*drij3;
+				const double s_dot_e = (mx * ex + my * ey + mz * ez);
 
+				hx+=(3.0 * s_dot_e * ex - mx)*drij3;
+				hy+=(3.0 * s_dot_e * ey - my)*drij3;
+				hz+=(3.0 * s_dot_e * ez - mz)*drij3;
+			}
 		}
 
-		cells::x_field_array[i]*=demag::prefactor;
-		cells::y_field_array[i]*=demag::prefactor;
-		cells::z_field_array[i]*=demag::prefactor;
-		
-		// Output data to vdp file
-		//vdp << i << "\t" << cells::num_atoms_in_cell[i] << "\t";
-		//vdp << cells::x_coord_array[i] << "\t" << cells::y_coord_array[i] << "\t" << cells::z_coord_array[i] << "\t";
-		//vdp << cells::x_field_array[i] << "\t" << cells::y_field_array[i] << "\t" << cells::z_field_array[i] << "\t";
-		//vdp << cells::x_mag_array[i] << "\t" << cells::y_mag_array[i] << "\t"<< cells::z_mag_array[i] << "\t" << inv_three_cell_volume*demag::prefactor*cells::z_mag_array[i] << std::endl;
-		
+		cells::x_field_array[i]+=demag::prefactor*hx;
+		cells::y_field_array[i]+=demag::prefactor*hy;
+		cells::z_field_array[i]+=demag::prefactor*hz;
+
 	}
-	//err::vexit();
+
+	// Update magnetisation of changed cells
+	for(int c=0;c<num_changed_cells;c++){
+		const int j = changed_cell_array[c];
+		cells::x_mag_update_array[j]=cells::x_mag_array[j];
+		cells::y_mag_update_array[j]=cells::y_mag_array[j];
+		cells::z_mag_update_array[j]=cells::z_mag_array[j];
+	}
+
 }
 
 /// @brief Wrapper Function to update demag fields
@@ -433,12 +1072,62 @@ void update(){
 		//if updated record last time at update
 		demag::update_time=sim::time;
 
+		// atomistic fields are calculated directly without macrocells
+		if(demag::atomistic==true){
+			atomistic_update();
+			return;
+		}
+
 		// update cell magnetisations
 		cells::mag();
-		
+
+		// Determine if fields need recalculating from change in cell magnetisation
+		bool partial=false;
+		if(demag::update_tolerance>0.0){
+
+			demag::statistics_checks+=1.0;
+
+			// time may have been reset by program since last full update
+			const bool recent = (sim::time>=demag::last_full_update_time &&
+			                     sim::time-demag::last_full_update_time<uint64_t(demag::maximum_update_interval));
+			if(recent){
+
+				// no significant change since last update
+				if(cells::max_mag_change<demag::update_tolerance) return;
+
+				changed_cell_array.resize(0);
+				for(int cell=0;cell<cells::num_cells;cell++){
+					if(cells::mag_change_array[cell]>=demag::update_tolerance) changed_cell_array.push_back(cell);
+				}
+
+				// partial update only for methods using direct point dipole tensor
+				const bool direct = (demag::compressed==false && demag::fft==false && demag::tree==false);
+				partial = (direct && double(changed_cell_array.size()) <= demag::partial_update_fraction*double(cells::num_cells));
+			}
+		}
+
 		// recalculate demag fields
-		if(demag::fast==true) fast_update();
-		else std_update();
+		if(partial==true){
+			demag::statistics_partial_updates+=1.0;
+			partial_update();
+		}
+		else{
+			if(demag::fast==true && demag::compressed==true) compressed_update();
+			else if(demag::fast==true) fast_update();
+			else if(demag::fft==true) fft_update();
+			else if(demag::tree==true) tree_update();
+			else std_update();
+
+			// Save cell magnetisation at full update
+			demag::statistics_full_updates+=1.0;
+			demag::last_full_update_time=sim::time;
+			cells::x_mag_update_array=cells::x_mag_array;
+			cells::y_mag_update_array=cells::y_mag_array;
+			cells::z_mag_update_array=cells::z_mag_array;
+		}
+
+		// Send fields of owned cells to CPUs with atoms in those cells
+		cells::distribute_field();
 		
 		// For MPI version, only add local atoms
 		#ifdef MPICF
@@ -0,0 +1,357 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains atomistic resolution dipolar field calculation
+///
+/// @details Atoms lie on the crystal lattice, so that each unit cell atom
+///          (sublattice) a forms a regular grid of unit cells. The dipolar
+///          field at atom a in unit cell i is
+///
+///          H_a(i) = SUM_b SUM_j N_ab(j-i) . m_b(j)
+///
+///          where the point dipole tensor N_ab depends only on the offset
+///          between unit cells, and each sublattice pair is a convolution
+///          evaluated by FFT on the zero padded unit cell grid. Since the
+///          dipole tensor is even in r, the kernel of pair ba is the kernel of
+///          pair ab reflected, whose transform is the complex conjugate, and
+///          only a <= b is stored. Each update requires 3 forward and 3 inverse
+///          transforms per sublattice. Self interaction is excluded and there
+///          is no macrocell self term.
+///
+///          Cell magnetisations are reduced over all CPUs, and each CPU
+///          performs the full convolution and keeps the fields of its local
+///          atoms.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    10/04/2012
+/// @internal
+///	Created:		10/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+#include "atoms.hpp"
+#include "cells.hpp"
+#include "create.hpp"
+#include "errors.hpp"
+#include "demag.hpp"
+#include "material.hpp"
+#include "vio.hpp"
+#include "vmath.hpp"
+#include "vmpi.hpp"
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+namespace demag{
+
+	bool atomistic=false;
+
+	namespace internal{
+
+		int num_sublattices;
+		int uc_min[3]; // minimum unit cell coordinates
+		int uc_n[3]; // unit cell grid dimensions
+		int uc_np[3]; // zero padded grid dimensions
+
+		// Fourier transformed interaction tensor for each sublattice pair a <= b, [pair][component][k]
+		std::vector<std::vector<std::vector<std::complex<double> > > > uc_tensor;
+
+		// Moments on unit cell grid [sublattice*3+component][cell]
+		std::vector<double> uc_moment;
+
+		// Fourier transformed moments and field work arrays
+		std::vector<std::vector<std::complex<double> > > uc_moment_k;
+		std::vector<std::vector<std::complex<double> > > uc_field_k;
+
+		inline int pair_index(const int a, const int b){
+			return a<=b ? a*num_sublattices - (a*(a-1))/2 + b-a : b*num_sublattices - (b*(b-1))/2 + a-b;
+		}
+
+	}
+
+/// @brief Function to initialise atomistic dipole tensors
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    10/04/2012
+///
+/// @internal
+///	Created:		10/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void atomistic_init(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::atomistic_init has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	using namespace demag::internal;
+
+	// For MPI version, only add local atoms
+	#ifdef MPICF
+		const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+	#else
+		const int num_local_atoms = atoms::num_atoms;
+	#endif
+
+	// unit cell atom data is deallocated after system creation
+	num_sublattices = cells::num_atoms_in_unit_cell;
+
+	// Determine extent of unit cell grid
+	int uc_max[3]={-1000000000,-1000000000,-1000000000};
+	for(int i=0;i<3;i++) uc_min[i]=1000000000;
+	for(int atom=0;atom<num_local_atoms;atom++){
+		const int sc[3]={atoms::x_supercell_array[atom],atoms::y_supercell_array[atom],atoms::z_supercell_array[atom]};
+		for(int i=0;i<3;i++){
+			if(sc[i]<uc_min[i]) uc_min[i]=sc[i];
+			if(sc[i]>uc_max[i]) uc_max[i]=sc[i];
+		}
+	}
+	#ifdef MPICF
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&uc_min[0],3,MPI_INT,MPI_MIN);
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&uc_max[0],3,MPI_INT,MPI_MAX);
+	#endif
+
+	// Determine position of each sublattice within unit cell (Angstroms)
+	std::vector<double> uc_offset(3*num_sublattices,-1.0e300);
+	for(int atom=0;atom<num_local_atoms;atom++){
+		const int a = atoms::uc_id_array[atom];
+		uc_offset[3*a+0] = atoms::x_coord_array[atom]-double(atoms::x_supercell_array[atom])*cs::unit_cell.dimensions[0];
+		uc_offset[3*a+1] = atoms::y_coord_array[atom]-double(atoms::y_supercell_array[atom])*cs::unit_cell.dimensions[1];
+		uc_offset[3*a+2] = atoms::z_coord_array[atom]-double(atoms::z_supercell_array[atom])*cs::unit_cell.dimensions[2];
+	}
+	#ifdef MPICF
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&uc_offset[0],uc_offset.size(),MPI_DOUBLE,MPI_MAX);
+	#endif
+
+	for(int i=0;i<3;i++){
+		uc_n[i]=uc_max[i]-uc_min[i]+1;
+		uc_np[i]=vmath::next_power_of_two(2*uc_n[i]-1);
+	}
+
+	const int num_cells=uc_n[0]*uc_n[1]*uc_n[2];
+	const int num_padded_cells=uc_np[0]*uc_np[1]*uc_np[2];
+	const int num_pairs=(num_sublattices*(num_sublattices+1))/2;
+
+	// Check memory requirements and print to screen
+	const double memory=(double(num_pairs*6+num_sublattices*3+3)*double(num_padded_cells)*16.0 + double(num_sublattices*3*num_cells)*8.0)/1.0e6;
+	zlog << zTs() << "Atomistic dipolar field calculation has been enabled for " << num_sublattices << " sublattices on a padded grid of "
+		  << uc_np[0] << " x " << uc_np[1] << " x " << uc_np[2] << " unit cells and requires " << memory << " MB of RAM" << std::endl;
+	std::cout << "Atomistic dipolar field calculation has been enabled and requires " << memory << " MB of RAM" << std::endl;
+
+	uc_moment.assign(num_sublattices*3*num_cells,0.0);
+	uc_moment_k.resize(num_sublattices*3);
+	for(int i=0;i<num_sublattices*3;i++) uc_moment_k[i].assign(num_padded_cells,0.0);
+	uc_field_k.resize(3);
+	for(int i=0;i<3;i++) uc_field_k[i].assign(num_padded_cells,0.0);
+
+	const double norm = 1.0/double(num_padded_cells);
+
+	// Calculate tensor for each sublattice pair
+	uc_tensor.resize(num_pairs);
+	for(int a=0;a<num_sublattices;a++){
+		for(int b=a;b<num_sublattices;b++){
+
+			std::vector<std::vector<std::complex<double> > >& N = uc_tensor[pair_index(a,b)];
+			N.resize(6);
+			for(int c=0;c<6;c++) N[c].assign(num_padded_cells,0.0);
+
+			// offset of atom b from atom a within unit cell
+			const double du[3]={uc_offset[3*b+0]-uc_offset[3*a+0],
+									  uc_offset[3*b+1]-uc_offset[3*a+1],
+									  uc_offset[3*b+2]-uc_offset[3*a+2]};
+
+			// Kernel K(k) = N(r) for atom b in cell i-k, stored with wrap around for negative offsets
+			for(int i=1-uc_n[0];i<uc_n[0];i++){
+				for(int j=1-uc_n[1];j<uc_n[1];j++){
+					for(int k=1-uc_n[2];k<uc_n[2];k++){
+
+						if(a==b && i==0 && j==0 && k==0) continue;
+
+						const double rx = du[0]-double(i)*cs::unit_cell.dimensions[0]; // Angstroms
+						const double ry = du[1]-double(j)*cs::unit_cell.dimensions[1];
+						const double rz = du[2]-double(k)*cs::unit_cell.dimensions[2];
+
+						const double rij = 1.0/sqrt(rx*rx+ry*ry+rz*rz);
+
+						const double ex = rx*rij;
+						const double ey = ry*rij;
+						const double ez = rz*rij;
+
+						const double rij3 = rij*rij*rij*norm; // include normalisation of inverse transform
+
+						const int id = (((i+uc_np[0])%uc_np[0])*uc_np[1] + (j+uc_np[1])%uc_np[1])*uc_np[2] + (k+uc_np[2])%uc_np[2];
+
+						N[0][id] = demag::prefactor*((3.0*ex*ex - 1.0)*rij3);
+						N[1][id] = demag::prefactor*(3.0*ex*ey)*rij3;
+						N[2][id] = demag::prefactor*(3.0*ex*ez)*rij3;
+
+						N[3][id] = demag::prefactor*((3.0*ey*ey - 1.0)*rij3);
+						N[4][id] = demag::prefactor*(3.0*ey*ez)*rij3;
+						N[5][id] = demag::prefactor*((3.0*ez*ez - 1.0)*rij3);
+
+					}
+				}
+			}
+
+			for(int c=0;c<6;c++) vmath::fft3d(N[c], uc_np, false);
+
+		}
+	}
+
+	return;
+
+}
+
+/// @brief Function to recalculate atomistic dipolar fields
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    10/04/2012
+///
+/// @internal
+///	Created:		10/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void atomistic_update(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::atomistic_update has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	using namespace demag::internal;
+
+	// For MPI version, only add local atoms
+	#ifdef MPICF
+		const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+	#else
+		const int num_local_atoms = atoms::num_atoms;
+	#endif
+
+	const int num_cells=uc_n[0]*uc_n[1]*uc_n[2];
+	const int num_padded_cells=uc_np[0]*uc_np[1]*uc_np[2];
+
+	// Calculate moments on unit cell grid
+	for(unsigned int i=0;i<uc_moment.size();i++) uc_moment[i]=0.0;
+
+	for(int atom=0;atom<num_local_atoms;atom++){
+		const int cell = ((atoms::x_supercell_array[atom]-uc_min[0])*uc_n[1] + atoms::y_supercell_array[atom]-uc_min[1])*uc_n[2] + atoms::z_supercell_array[atom]-uc_min[2];
+		const int a = atoms::uc_id_array[atom];
+		const double mus = mp::material[atoms::type_array[atom]].mu_s_SI;
+		uc_moment[(3*a+0)*num_cells+cell] = atoms::x_spin_array[atom]*mus;
+		uc_moment[(3*a+1)*num_cells+cell] = atoms::y_spin_array[atom]*mus;
+		uc_moment[(3*a+2)*num_cells+cell] = atoms::z_spin_array[atom]*mus;
+	}
+
+	#ifdef MPICF
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&uc_moment[0],uc_moment.size(),MPI_DOUBLE,MPI_SUM);
+	#endif
+
+	// Copy moments to padded grid and transform
+	for(int c=0;c<num_sublattices*3;c++){
+		std::vector<std::complex<double> >& M = uc_moment_k[c];
+		for(int id=0;id<num_padded_cells;id++) M[id]=0.0;
+		for(int i=0;i<uc_n[0];i++){
+			for(int j=0;j<uc_n[1];j++){
+				for(int k=0;k<uc_n[2];k++){
+					M[(i*uc_np[1]+j)*uc_np[2]+k]=uc_moment[c*num_cells+(i*uc_n[1]+j)*uc_n[2]+k];
+				}
+			}
+		}
+		vmath::fft3d(M, uc_np, false);
+	}
+
+	// Field on each sublattice
+	for(int a=0;a<num_sublattices;a++){
+
+		for(int c=0;c<3;c++) for(int id=0;id<num_padded_cells;id++) uc_field_k[c][id]=0.0;
+
+		// Multiply by tensor in Fourier space, H_a = SUM_b N_ab.M_b
+		for(int b=0;b<num_sublattices;b++){
+			const std::vector<std::vector<std::complex<double> > >& N = uc_tensor[pair_index(a,b)];
+			const std::vector<std::complex<double> >& Mx = uc_moment_k[3*b+0];
+			const std::vector<std::complex<double> >& My = uc_moment_k[3*b+1];
+			const std::vector<std::complex<double> >& Mz = uc_moment_k[3*b+2];
+			if(a<=b){
+				for(int id=0;id<num_padded_cells;id++){
+					uc_field_k[0][id] += N[0][id]*Mx[id] + N[1][id]*My[id] + N[2][id]*Mz[id];
+					uc_field_k[1][id] += N[1][id]*Mx[id] + N[3][id]*My[id] + N[4][id]*Mz[id];
+					uc_field_k[2][id] += N[2][id]*Mx[id] + N[4][id]*My[id] + N[5][id]*Mz[id];
+				}
+			}
+			// reflected kernel for b < a
+			else{
+				for(int id=0;id<num_padded_cells;id++){
+					uc_field_k[0][id] += conj(N[0][id])*Mx[id] + conj(N[1][id])*My[id] + conj(N[2][id])*Mz[id];
+					uc_field_k[1][id] += conj(N[1][id])*Mx[id] + conj(N[3][id])*My[id] + conj(N[4][id])*Mz[id];
+					uc_field_k[2][id] += conj(N[2][id])*Mx[id] + conj(N[4][id])*My[id] + conj(N[5][id])*Mz[id];
+				}
+			}
+		}
+
+		for(int c=0;c<3;c++) vmath::fft3d(uc_field_k[c], uc_np, true);
+
+		// Copy field to local atoms of sublattice
+		for(int atom=0;atom<num_local_atoms;atom++){
+			if(atoms::uc_id_array[atom]!=a) continue;
+			const int id = ((atoms::x_supercell_array[atom]-uc_min[0])*uc_np[1] + atoms::y_supercell_array[atom]-uc_min[1])*uc_np[2] + atoms::z_supercell_array[atom]-uc_min[2];
+			atoms::x_dipolar_field_array[atom]=uc_field_k[0][id].real();
+			atoms::y_dipolar_field_array[atom]=uc_field_k[1][id].real();
+			atoms::z_dipolar_field_array[atom]=uc_field_k[2][id].real();
+		}
+
+	}
+
+	return;
+
+}
+
+} // end of namespace demag
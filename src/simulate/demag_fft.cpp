@@ -0,0 +1,291 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains FFT accelerated demag field calculation
+///
+/// @details Macrocells lie on a regular grid of num_cells_x x num_cells_y x
+///          num_cells_z cells of width cells::size, so that the point dipole
+///          interaction between cells depends only on their offset and the
+///          field is a discrete convolution
+///
+///          H_i = SUM_j N(r_j - r_i) . m_j
+///
+///          The grid is zero padded to at least 2n-1 cells in each direction
+///          so that the cyclic convolution of the FFT reproduces the open
+///          boundary sum. The six components of N are transformed once at
+///          initialisation, and each update requires three forward and three
+///          inverse transforms, O(N log N). The self-demagnetisation term
+///          -4pi/3V m depends on the cell volume and is added afterwards.
+///
+///          Cells are placed at the centres of the regular grid rather than
+///          at the magnetic centre of mass used by the direct sum, which is
+///          identical for completely filled cells.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    30/03/2012
+/// @internal
+///	Created:		30/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+#include "cells.hpp"
+#include "errors.hpp"
+#include "demag.hpp"
+#include "vio.hpp"
+#include "vmath.hpp"
+#include "vmpi.hpp"
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+namespace demag{
+
+	bool fft=false;
+
+	namespace internal{
+
+		int n[3]; // macrocell grid dimensions
+		int np[3]; // zero padded grid dimensions
+
+		// Fourier transformed interaction tensor
+		std::vector<std::complex<double> > Nxx;
+		std::vector<std::complex<double> > Nxy;
+		std::vector<std::complex<double> > Nxz;
+		std::vector<std::complex<double> > Nyy;
+		std::vector<std::complex<double> > Nyz;
+		std::vector<std::complex<double> > Nzz;
+
+		// work arrays for cell magnetisation and field
+		std::vector<std::complex<double> > Mx;
+		std::vector<std::complex<double> > My;
+		std::vector<std::complex<double> > Mz;
+
+	}
+
+/// @brief Function to initialise FFT demag tensor
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    30/03/2012
+///
+/// @internal
+///	Created:		30/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void fft_init(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::fft_init has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	using namespace demag::internal;
+
+	n[0]=cells::num_cells_x;
+	n[1]=cells::num_cells_y;
+	n[2]=cells::num_cells_z;
+
+	for(int i=0;i<3;i++) np[i]=vmath::next_power_of_two(2*n[i]-1);
+
+	const int num_padded_cells=np[0]*np[1]*np[2];
+
+	// Check memory requirements and print to screen
+	zlog << zTs() << "FFT demagnetisation field calculation has been enabled on a padded grid of " << np[0] << " x " << np[1] << " x " << np[2]
+		  << " cells and requires " << double(num_padded_cells)*9.0*16.0/1.0e6 << " MB of RAM" << std::endl;
+	std::cout << "FFT demagnetisation field calculation has been enabled and requires " << double(num_padded_cells)*9.0*16.0/1.0e6 << " MB of RAM" << std::endl;
+
+	Nxx.assign(num_padded_cells,0.0);
+	Nxy.assign(num_padded_cells,0.0);
+	Nxz.assign(num_padded_cells,0.0);
+	Nyy.assign(num_padded_cells,0.0);
+	Nyz.assign(num_padded_cells,0.0);
+	Nzz.assign(num_padded_cells,0.0);
+
+	Mx.assign(num_padded_cells,0.0);
+	My.assign(num_padded_cells,0.0);
+	Mz.assign(num_padded_cells,0.0);
+
+	// Calculate tensor for all cell offsets, stored with wrap around for negative offsets
+	for(int i=1-n[0];i<n[0];i++){
+		for(int j=1-n[1];j<n[1];j++){
+			for(int k=1-n[2];k<n[2];k++){
+
+				// cell interacts with its own images for periodic systems
+				if(i==0 && j==0 && k==0 && demag::periodic==false) continue;
+
+				const double rx = double(i)*cells::size; // Angstroms
+				const double ry = double(j)*cells::size;
+				const double rz = double(k)*cells::size;
+
+				double rij[6];
+				demag::interaction_tensor(rx, ry, rz, rij);
+
+				const int id = (((i+np[0])%np[0])*np[1] + (j+np[1])%np[1])*np[2] + (k+np[2])%np[2];
+
+				Nxx[id] = rij[0];
+				Nxy[id] = rij[1];
+				Nxz[id] = rij[2];
+
+				Nyy[id] = rij[3];
+				Nyz[id] = rij[4];
+				Nzz[id] = rij[5];
+
+			}
+		}
+	}
+
+	// Transform tensor and include normalisation of inverse transform
+	vmath::fft3d(Nxx, np, false);
+	vmath::fft3d(Nxy, np, false);
+	vmath::fft3d(Nxz, np, false);
+	vmath::fft3d(Nyy, np, false);
+	vmath::fft3d(Nyz, np, false);
+	vmath::fft3d(Nzz, np, false);
+
+	const double norm = 1.0/double(num_padded_cells);
+	for(int id=0;id<num_padded_cells;id++){
+		Nxx[id]*=norm;
+		Nxy[id]*=norm;
+		Nxz[id]*=norm;
+		Nyy[id]*=norm;
+		Nyz[id]*=norm;
+		Nzz[id]*=norm;
+	}
+
+	return;
+
+}
+
+/// @brief Function to recalculate demag fields using FFT convolution
+///
+/// @details Cell magnetisations are known on all CPUs after cells::mag(),
+///          so each CPU performs the full convolution and keeps the fields
+///          of its local cells.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    30/03/2012
+///
+/// @internal
+///	Created:		30/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void fft_update(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::fft_update has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	using namespace demag::internal;
+
+	const int num_padded_cells=np[0]*np[1]*np[2];
+
+	// Copy cell magnetisation to padded grid
+	for(int id=0;id<num_padded_cells;id++){
+		Mx[id]=0.0;
+		My[id]=0.0;
+		Mz[id]=0.0;
+	}
+	for(int i=0;i<n[0];i++){
+		for(int j=0;j<n[1];j++){
+			for(int k=0;k<n[2];k++){
+				const int cell = (i*n[1]+j)*n[2]+k;
+				const int id = (i*np[1]+j)*np[2]+k;
+				Mx[id]=cells::x_mag_array[cell];
+				My[id]=cells::y_mag_array[cell];
+				Mz[id]=cells::z_mag_array[cell];
+			}
+		}
+	}
+
+	vmath::fft3d(Mx, np, false);
+	vmath::fft3d(My, np, false);
+	vmath::fft3d(Mz, np, false);
+
+	// Multiply by tensor in Fourier space, H = N.M
+	for(int id=0;id<num_padded_cells;id++){
+		const std::complex<double> mx = Mx[id];
+		const std::complex<double> my = My[id];
+		const std::complex<double> mz = Mz[id];
+		Mx[id] = Nxx[id]*mx + Nxy[id]*my + Nxz[id]*mz;
+		My[id] = Nxy[id]*mx + Nyy[id]*my + Nyz[id]*mz;
+		Mz[id] = Nxz[id]*mx + Nyz[id]*my + Nzz[id]*mz;
+	}
+
+	vmath::fft3d(Mx, np, true);
+	vmath::fft3d(My, np, true);
+	vmath::fft3d(Mz, np, true);
+
+	// loop over local cells
+	for(int lc=0;lc<cells::num_local_cells;lc++){
+
+		// get global cell ID and position in padded grid
+		const int cell = cells::local_cell_array[lc];
+		const int k = cell%n[2];
+		const int j = (cell/n[2])%n[1];
+		const int i = cell/(n[1]*n[2]);
+		const int id = (i*np[1]+j)*np[2]+k;
+
+		// Calculate inverse volume from number of atoms in macrocell
+		// V in A^3 == 1e-30 m3, mu_0 = 4pie-7 -> prefactor = pi*4e23/3V
+		const double mu0_three_cell_volume = -4.0e23*M_PI/(3.0*cells::volume_array[cell]);
+
+		// Add self-demagnetisation
+		cells::x_field_array[cell]=mu0_three_cell_volume*cells::x_mag_array[cell] + Mx[id].real();
+		cells::y_field_array[cell]=mu0_three_cell_volume*cells::y_mag_array[cell] + My[id].real();
+		cells::z_field_array[cell]=mu0_three_cell_volume*cells::z_mag_array[cell] + Mz[id].real();
+
+	}
+
+	return;
+
+}
+
+} // end of namespace demag
@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains macrocell interaction tensor including near field cuboid terms
+///
+/// @details The point dipole approximation for the interaction between
+///          neighbouring macrocells is poor, with an error of 15% for nearest
+///          neighbours. Within a cutoff the exact mean field of a uniformly
+///          magnetised cube of width cells::size acting on a second cube is
+///          used instead, given by the demagnetisation tensor of
+///          A J Newell, W Williams and D J Dunlop, J. Geophys. Res. 98, 9551 (1993)
+///
+///          N_xx(X,Y,Z) = 1/(4 pi a^3) SUM w_i w_j w_k f(X+ia, Y+ja, Z+ka)
+///
+///          where the sum is over i,j,k = -1,0,1 with weights w = (-1,2,-1),
+///          and N_xy uses the function g. Beyond the cutoff the tensor tends
+///          to the point dipole form, which is used since the differences
+///          lose precision at large distances.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    16/04/2012
+/// @internal
+///	Created:		16/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+#include "cells.hpp"
+#include "demag.hpp"
+
+#include <cmath>
+
+namespace demag{
+
+	bool newell=false;
+	double newell_cutoff=4.0; /// cutoff for cuboid interactions in cell widths
+
+	namespace internal{
+
+		// Newell function for diagonal components, even in x,y,z
+		double newell_f(double x, double y, double z){
+
+			x=fabs(x);
+			y=fabs(y);
+			z=fabs(z);
+
+			const double x2=x*x;
+			const double y2=y*y;
+			const double z2=z*z;
+			const double R=sqrt(x2+y2+z2);
+
+			if(R==0.0) return 0.0;
+
+			// terms with vanishing prefactors are omitted
+			double result=(2.0*x2-y2-z2)*R/6.0;
+			if(y>0.0 && x2+z2>0.0) result+=0.5*y*(z2-x2)*asinh(y/sqrt(x2+z2));
+			if(z>0.0 && x2+y2>0.0) result+=0.5*z*(y2-x2)*asinh(z/sqrt(x2+y2));
+			if(x>0.0 && y>0.0 && z>0.0) result-=x*y*z*atan(y*z/(x*R));
+
+			return result;
+
+		}
+
+		// Newell function for off-diagonal components, odd in x,y and even in z
+		double newell_g(double x, double y, double z){
+
+			const double sign=(x<0.0 ? -1.0 : 1.0)*(y<0.0 ? -1.0 : 1.0);
+
+			x=fabs(x);
+			y=fabs(y);
+			z=fabs(z);
+
+			const double x2=x*x;
+			const double y2=y*y;
+			const double z2=z*z;
+			const double R=sqrt(x2+y2+z2);
+
+			if(R==0.0) return 0.0;
+
+			double result=-x*y*R/3.0;
+			if(z>0.0 && x2+y2>0.0) result+=x*y*z*asinh(z/sqrt(x2+y2));
+			if(x>0.0 && y2+z2>0.0) result+=y*(3.0*z2-y2)*asinh(x/sqrt(y2+z2))/6.0;
+			if(y>0.0 && x2+z2>0.0) result+=x*(3.0*z2-x2)*asinh(y/sqrt(x2+z2))/6.0;
+			if(z>0.0) result-=z2*z*atan(x*y/(z*R))/6.0;
+			if(y>0.0) result-=0.5*z*y2*atan(x*z/(y*R));
+			if(x>0.0) result-=0.5*z*x2*atan(y*z/(x*R));
+
+			return sign*result;
+
+		}
+
+		// Second difference of Newell function over neighbouring cells
+		double newell_sum(double (*func)(double, double, double), const double x, const double y, const double z, const double a){
+
+			const double w[3]={-1.0,2.0,-1.0};
+
+			double sum=0.0;
+			for(int i=-1;i<=1;i++){
+				for(int j=-1;j<=1;j++){
+					for(int k=-1;k<=1;k++){
+						sum+=w[i+1]*w[j+1]*w[k+1]*func(x+double(i)*a,y+double(j)*a,z+double(k)*a);
+					}
+				}
+			}
+
+			return sum;
+
+		}
+
+	}
+
+/// @brief Function to calculate interaction tensor between two macrocells
+///
+/// @details Returns rij = (xx, xy, xz, yy, yz, zz) such that the field at
+///          cell i is H = rij.m_j with m_j in J/T and H in Tesla, for a
+///          separation r = r_j - r_i in Angstroms. Excludes the self term.
+///          Includes periodic images of cell j if periodic dipole fields
+///          are enabled.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    16/04/2012
+///
+/// @internal
+///	Created:		16/04/2012
+///	Revision:	  23/04/2012
+///=====================================================================================
+///
+void interaction_tensor(const double rx, const double ry, const double rz, double rij[6]){
+
+	if(demag::periodic==true) demag::internal::periodic_tensor(rx, ry, rz, rij);
+	else demag::internal::pair_tensor(rx, ry, rz, rij);
+
+	return;
+
+}
+
+namespace internal{
+
+/// @brief Function to calculate interaction tensor for a single pair of macrocells
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    16/04/2012
+///
+/// @internal
+///	Created:		16/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void pair_tensor(const double rx, const double ry, const double rz, double rij[6]){
+
+	const double r2 = rx*rx+ry*ry+rz*rz;
+	const double a = cells::size;
+
+	if(demag::newell==true && r2 < demag::newell_cutoff*demag::newell_cutoff*a*a){
+
+		using namespace demag::internal;
+
+		// H = -mu_0 N m/V, with N = sum/(4 pi V) and V = a^3 in A^3 -> -1e-7 sum m/V^2 (SI)
+		const double scale = -demag::prefactor/(a*a*a*a*a*a);
+
+		rij[0] = scale*newell_sum(newell_f, rx, ry, rz, a);
+		rij[1] = scale*newell_sum(newell_g, rx, ry, rz, a);
+		rij[2] = scale*newell_sum(newell_g, rx, rz, ry, a);
+		rij[3] = scale*newell_sum(newell_f, ry, rx, rz, a);
+		rij[4] = scale*newell_sum(newell_g, ry, rz, rx, a);
+		rij[5] = scale*newell_sum(newell_f, rz, ry, rx, a);
+
+		return;
+
+	}
+
+	const double irij = 1.0/sqrt(r2);
+
+	const double ex = rx*irij;
+	const double ey = ry*irij;
+	const double ez = rz*irij;
+
+	const double irij3 = irij*irij*irij; // Angstroms
+
+	rij[0] = demag::prefactor*((3.0*ex*ex - 1.0)*irij3);
+	rij[1] = demag::prefactor*(3.0*ex*ey)*irij3;
+	rij[2] = demag::prefactor*(3.0*ex*ez)*irij3;
+
+	rij[3] = demag::prefactor*((3.0*ey*ey - 1.0)*irij3);
+	rij[4] = demag::prefactor*(3.0*ey*ez)*irij3;
+	rij[5] = demag::prefactor*((3.0*ez*ez - 1.0)*irij3);
+
+	return;
+
+}
+
+} // end of namespace internal
+
+} // end of namespace demag
@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains periodic image sums of the macrocell interaction tensor
+///
+/// @details For systems with periodic boundaries the interaction between two
+///          macrocells includes all periodic images of the source cell,
+///          displaced by multiples of cs::system_dimensions along the periodic
+///          directions. Images within a radius R of the target cell are summed
+///          explicitly and the remainder is replaced by a uniform continuum:
+///
+///          one periodic direction (wire), per moment and length L
+///             T_aa = 2/(L R^2), T_bb = T_cc = -1/(L R^2)
+///
+///          two periodic directions (film), per moment and area A
+///             T_aa = T_bb = pi/(A R), T_cc = -2 pi/(A R)
+///
+///          Both lattice sums converge absolutely. For three periodic
+///          directions the sum is conditionally convergent and the spherical
+///          truncation used here corresponds to a spherical sample, for which
+///          the continuum remainder vanishes.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    23/04/2012
+/// @internal
+///	Created:		23/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+#include "create.hpp"
+#include "demag.hpp"
+#include "vio.hpp"
+
+#include <cmath>
+#include <iostream>
+
+namespace demag{
+
+	bool periodic=false;
+	int periodic_images=10; /// radius of explicit image sum in system lengths
+
+	namespace internal{
+
+		int num_periodic_dimensions=0;
+		double period[3]={0.0,0.0,0.0}; /// image displacement, zero for open directions
+		int max_image[3]={0,0,0};
+		double image_radius=0.0;
+		double continuum_tensor[6]={0.0,0.0,0.0,0.0,0.0,0.0};
+
+	}
+
+/// @brief Function to initialise periodic image sums from boundary conditions
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    23/04/2012
+///
+/// @internal
+///	Created:		23/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void periodic_init(){
+
+	using namespace demag::internal;
+
+	if(demag::periodic==false) return;
+
+	num_periodic_dimensions=0;
+	double max_period=0.0;
+	for(int d=0;d<3;d++){
+		period[d] = (cs::pbc[d]==true) ? cs::system_dimensions[d] : 0.0;
+		if(cs::pbc[d]==true) num_periodic_dimensions++;
+		if(period[d]>max_period) max_period=period[d];
+	}
+
+	if(num_periodic_dimensions==0){
+		zlog << zTs() << "Warning - periodic dipole fields requested without periodic boundary conditions, ignoring" << std::endl;
+		demag::periodic=false;
+		return;
+	}
+
+	image_radius = double(demag::periodic_images)*max_period;
+	for(int d=0;d<3;d++) max_image[d] = (cs::pbc[d]==true) ? int(ceil(image_radius/period[d]))+1 : 0;
+
+	// continuum remainder outside image radius, xx,xy,xz,yy,yz,zz
+	for(int c=0;c<6;c++) continuum_tensor[c]=0.0;
+	const int diagonal[3]={0,3,5};
+	if(num_periodic_dimensions==1){
+		double length=0.0;
+		for(int d=0;d<3;d++) if(cs::pbc[d]==true) length=period[d];
+		const double t = demag::prefactor/(length*image_radius*image_radius);
+		for(int d=0;d<3;d++) continuum_tensor[diagonal[d]] = (cs::pbc[d]==true) ? 2.0*t : -t;
+	}
+	else if(num_periodic_dimensions==2){
+		double area=1.0;
+		for(int d=0;d<3;d++) if(cs::pbc[d]==true) area*=period[d];
+		const double t = demag::prefactor*M_PI/(area*image_radius);
+		for(int d=0;d<3;d++) continuum_tensor[diagonal[d]] = (cs::pbc[d]==true) ? t : -2.0*t;
+	}
+
+	zlog << zTs() << "Periodic dipole fields enabled with period " << period[0] << " " << period[1] << " " << period[2];
+	zlog << " A and image radius " << image_radius << " A" << std::endl;
+
+	// only solvers with precalculated interactions include periodic images
+	if(demag::fast==false && demag::fft==false){
+		zlog << zTs() << "Warning - periodic dipole fields are only used with fast or FFT demagnetisation field calculation" << std::endl;
+	}
+
+}
+
+namespace internal{
+
+/// @brief Function to calculate interaction tensor summed over periodic images
+///
+/// @details Includes the images of a cell acting on itself when r = 0.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    23/04/2012
+///
+/// @internal
+///	Created:		23/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void periodic_tensor(const double rx, const double ry, const double rz, double rij[6]){
+
+	for(int c=0;c<6;c++) rij[c]=continuum_tensor[c];
+
+	const double radius2=image_radius*image_radius;
+
+	for(int i=-max_image[0];i<=max_image[0];i++){
+		for(int j=-max_image[1];j<=max_image[1];j++){
+			for(int k=-max_image[2];k<=max_image[2];k++){
+
+				const double ix = rx + double(i)*period[0];
+				const double iy = ry + double(j)*period[1];
+				const double iz = rz + double(k)*period[2];
+
+				const double r2 = ix*ix+iy*iy+iz*iz;
+				if(r2==0.0 || r2>radius2) continue;
+
+				double tij[6];
+				pair_tensor(ix, iy, iz, tij);
+				for(int c=0;c<6;c++) rij[c]+=tij[c];
+
+			}
+		}
+	}
+
+	return;
+
+}
+
+} // end of namespace internal
+
+} // end of namespace demag
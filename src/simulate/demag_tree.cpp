@@ -0,0 +1,366 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains tree code (Barnes-Hut) demag field calculation
+///
+/// @details Occupied macrocells are sorted into an octree at initialisation.
+///          Every update the total moment of each node is summed from its
+///          children, and the field at each local cell is found by walking
+///          the tree from the root. A node of size s at distance d from the
+///          cell is treated as a single point dipole at its centre if
+///
+///          s < theta d
+///
+///          and is otherwise opened, with leaves summed directly. The opening
+///          angle theta controls the accuracy; theta = 0 reproduces the direct
+///          sum. Only occupied cells enter the tree, so that the cost scales
+///          as O(N log N) in the number of occupied cells regardless of the
+///          shape of the system.
+///
+///          Ref. J Barnes and P Hut, Nature 324, 446 (1986)
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    04/04/2012
+/// @internal
+///	Created:		04/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+#include "cells.hpp"
+#include "errors.hpp"
+#include "demag.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace demag{
+
+	bool tree=false;
+	double tree_opening_angle=0.5;
+
+	namespace internal{
+
+		//-----------------------------------------------------------------------------
+		// Node of octree, leaves hold a range of cells in tree_cell_array
+		//-----------------------------------------------------------------------------
+		class node_t{
+
+			public:
+				double centre[3]; // volume weighted centre of cells in node (A)
+				double size; // largest extent of cells in node (A)
+				double min[3]; // bounding box of cell coordinates (A)
+				double max[3];
+				double m[3]; // total moment of node (J/T)
+				int child[8];
+				int first; // range of cells in tree_cell_array
+				int last;
+				bool leaf;
+
+		};
+
+		const int max_cells_in_leaf=8;
+
+		std::vector<node_t> nodes;
+		std::vector<int> tree_cell_array; // occupied cells ordered by tree
+		std::vector<int> node_stack;
+
+		//-----------------------------------------------------------------------------
+		// Function to recursively build node for range of tree_cell_array
+		//-----------------------------------------------------------------------------
+		int build_node(const int first, const int last){
+
+			const int id = nodes.size();
+			nodes.push_back(node_t());
+
+			double min[3]={1.0e300,1.0e300,1.0e300};
+			double max[3]={-1.0e300,-1.0e300,-1.0e300};
+			double centre[3]={0.0,0.0,0.0};
+			double volume=0.0;
+
+			for(int c=first;c<last;c++){
+				const int cell=tree_cell_array[c];
+				const double r[3]={cells::x_coord_array[cell],cells::y_coord_array[cell],cells::z_coord_array[cell]};
+				for(int i=0;i<3;i++){
+					if(r[i]<min[i]) min[i]=r[i];
+					if(r[i]>max[i]) max[i]=r[i];
+					centre[i]+=r[i]*cells::volume_array[cell];
+				}
+				volume+=cells::volume_array[cell];
+			}
+
+			double size=0.0;
+			for(int i=0;i<3;i++){
+				nodes[id].centre[i]=centre[i]/volume;
+				nodes[id].min[i]=min[i];
+				nodes[id].max[i]=max[i];
+				if(max[i]-min[i]>size) size=max[i]-min[i];
+			}
+			// include extent of cells themselves
+			nodes[id].size=size+cells::size;
+			nodes[id].first=first;
+			nodes[id].last=last;
+			for(int i=0;i<8;i++) nodes[id].child[i]=-1;
+
+			// Leaf if few cells or all cells coincide
+			if(last-first<=max_cells_in_leaf || size==0.0){
+				nodes[id].leaf=true;
+				return id;
+			}
+			nodes[id].leaf=false;
+
+			// Sort cells into octants about midpoint of bounding box
+			const double mid[3]={0.5*(min[0]+max[0]),0.5*(min[1]+max[1]),0.5*(min[2]+max[2])};
+			std::vector<std::vector<int> > octant_cells(8);
+			for(int c=first;c<last;c++){
+				const int cell=tree_cell_array[c];
+				int octant=0;
+				if(cells::x_coord_array[cell]>mid[0]) octant+=1;
+				if(cells::y_coord_array[cell]>mid[1]) octant+=2;
+				if(cells::z_coord_array[cell]>mid[2]) octant+=4;
+				octant_cells[octant].push_back(cell);
+			}
+
+			int c=first;
+			int octant_first[8];
+			for(int o=0;o<8;o++){
+				octant_first[o]=c;
+				for(unsigned int i=0;i<octant_cells[o].size();i++) tree_cell_array[c++]=octant_cells[o][i];
+			}
+
+			for(int o=0;o<8;o++){
+				const int num=octant_cells[o].size();
+				if(num>0){
+					const int child=build_node(octant_first[o],octant_first[o]+num);
+					nodes[id].child[o]=child; // nodes may have been reallocated
+				}
+			}
+
+			return id;
+
+		}
+
+		//-----------------------------------------------------------------------------
+		// Function to sum moments of nodes from leaves upwards. Children always
+		// have higher IDs than their parents.
+		//-----------------------------------------------------------------------------
+		void sum_node_moments(){
+
+			for(int id=nodes.size()-1;id>=0;id--){
+				node_t& node=nodes[id];
+				node.m[0]=0.0;
+				node.m[1]=0.0;
+				node.m[2]=0.0;
+				if(node.leaf){
+					for(int c=node.first;c<node.last;c++){
+						const int cell=tree_cell_array[c];
+						node.m[0]+=cells::x_mag_array[cell];
+						node.m[1]+=cells::y_mag_array[cell];
+						node.m[2]+=cells::z_mag_array[cell];
+					}
+				}
+				else{
+					for(int o=0;o<8;o++){
+						const int child=node.child[o];
+						if(child<0) continue;
+						node.m[0]+=nodes[child].m[0];
+						node.m[1]+=nodes[child].m[1];
+						node.m[2]+=nodes[child].m[2];
+					}
+				}
+			}
+
+			return;
+
+		}
+
+		//-----------------------------------------------------------------------------
+		// Function to add point dipole field of moment m at displacement d = rj - ri
+		//-----------------------------------------------------------------------------
+		inline void add_dipole_field(const double dx, const double dy, const double dz,
+											  const double mx, const double my, const double mz, double h[3]){
+
+			const double drij = 1.0/sqrt(dx*dx+dy*dy+dz*dz);
+			const double drij3 = drij*drij*drij; // Angstroms
+
+			const double ex = dx*drij;
+			const double ey = dy*drij;
+			const double ez = dz*drij;
+
+			const double s_dot_e = (mx * ex + my * ey + mz * ez);
+
+			h[0]+=(3.0 * s_dot_e * ex - mx)*drij3;
+			h[1]+=(3.0 * s_dot_e * ey - my)*drij3;
+			h[2]+=(3.0 * s_dot_e * ez - mz)*drij3;
+
+		}
+
+	} // end of namespace internal
+
+/// @brief Function to build octree of occupied macrocells
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    04/04/2012
+///
+/// @internal
+///	Created:		04/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void tree_init(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::tree_init has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	using namespace demag::internal;
+
+	// Add all occupied cells (known on all CPUs)
+	tree_cell_array.resize(0);
+	for(int cell=0;cell<cells::num_cells;cell++) if(cells::volume_array[cell]>0.0) tree_cell_array.push_back(cell);
+
+	nodes.resize(0);
+	if(tree_cell_array.size()>0) build_node(0,tree_cell_array.size());
+
+	zlog << zTs() << "Tree demagnetisation field calculation has been enabled with " << tree_cell_array.size() << " occupied cells in "
+		  << nodes.size() << " nodes and opening angle " << demag::tree_opening_angle << std::endl;
+
+	return;
+
+}
+
+/// @brief Function to recalculate demag fields using tree code
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    04/04/2012
+///
+/// @internal
+///	Created:		04/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void tree_update(){
+
+	// check for calling of routine
+	if(err::check==true){
+		terminaltextcolor(RED);
+		std::cerr << "demag::tree_update has been called " << vmpi::my_rank << std::endl;
+		terminaltextcolor(WHITE);
+	}
+
+	using namespace demag::internal;
+
+	if(nodes.size()==0) return;
+
+	sum_node_moments();
+
+	const double theta = demag::tree_opening_angle;
+
+	// loop over local cells
+	for(int lc=0;lc<cells::num_local_cells;lc++){
+
+		// get global cell ID
+		const int i = cells::local_cell_array[lc];
+		const double ri[3]={cells::x_coord_array[i],cells::y_coord_array[i],cells::z_coord_array[i]};
+
+		double h[3]={0.0,0.0,0.0};
+
+		// walk tree from root
+		node_stack.resize(0);
+		node_stack.push_back(0);
+		while(node_stack.size()>0){
+
+			const node_t& node=nodes[node_stack.back()];
+			node_stack.pop_back();
+
+			const double dx = node.centre[0]-ri[0];
+			const double dy = node.centre[1]-ri[1];
+			const double dz = node.centre[2]-ri[2];
+			const double d2 = dx*dx+dy*dy+dz*dz;
+
+			// Check if cell lies within bounding box of node
+			const bool inside = ri[0]>=node.min[0] && ri[0]<=node.max[0] &&
+									  ri[1]>=node.min[1] && ri[1]<=node.max[1] &&
+									  ri[2]>=node.min[2] && ri[2]<=node.max[2];
+
+			// Far node, use total moment at centre
+			if(!inside && node.size*node.size < theta*theta*d2){
+				add_dipole_field(dx, dy, dz, node.m[0], node.m[1], node.m[2], h);
+			}
+			// Near leaf, sum cells directly
+			else if(node.leaf){
+				for(int c=node.first;c<node.last;c++){
+					const int j=tree_cell_array[c];
+					if(j==i) continue;
+					add_dipole_field(cells::x_coord_array[j]-ri[0], cells::y_coord_array[j]-ri[1], cells::z_coord_array[j]-ri[2],
+										  cells::x_mag_array[j], cells::y_mag_array[j], cells::z_mag_array[j], h);
+				}
+			}
+			// Otherwise open node
+			else{
+				for(int o=0;o<8;o++) if(node.child[o]>=0) node_stack.push_back(node.child[o]);
+			}
+		}
+
+		// Calculate inverse volume from number of atoms in macrocell
+		// V in A^3 == 1e-30 m3, mu_0 = 4pie-7 -> prefactor = pi*4/3V
+		const double mu0_three_cell_volume = -4.0*M_PI/(3.0*cells::volume_array[i]);
+
+		// Add self-demagnetisation
+		cells::x_field_array[i]=demag::prefactor*(mu0_three_cell_volume*cells::x_mag_array[i] + h[0]);
+		cells::y_field_array[i]=demag::prefactor*(mu0_three_cell_volume*cells::y_mag_array[i] + h[1]);
+		cells::z_field_array[i]=demag::prefactor*(mu0_three_cell_volume*cells::z_mag_array[i] + h[2]);
+
+	}
+
+	return;
+
+}
+
+} // end of namespace demag
@@ -61,6 +61,11 @@
 #include "vio.hpp"
 #include "vmpi.hpp"
 
+#ifdef MPICF
+int mpi_init_halo_swap();
+int mpi_complete_halo_swap();
+#endif
+
 namespace sim{
 
 /// @brief Calculates the exchange energy for a single spin (isotropic).
@@ -554,5 +559,255 @@ double calculate_spin_energy(const int atom, const int AtomExchangeType){
 	return energy; // Tesla
 }
 
-} // end of namespace sim
+/// @brief Calculates the exchange field acting on a single spin.
+///
+/// @details The field follows the convention of the LLG field routines,
+///          H = -sum_j Jij S_j, so that the exchange energy of spin S is
+///          -S.H. The field only depends on the neighbouring spins and can
+///          therefore be reused for any trial position of the local spin.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    20/03/2012
+///
+/// @param[in] atom atom number
+/// @param[in] AtomExchangeType exchange type (0 isotropic, 1 vector, 2 tensor)
+/// @param[out] H exchange field (Tesla)
+///
+/// @internal
+///	Created:		20/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void spin_exchange_field(const int atom, const int AtomExchangeType, double H[3]){
+
+	H[0]=0.0;
+	H[1]=0.0;
+	H[2]=0.0;
+
+	const int start=atoms::neighbour_list_start_index[atom];
+	const int end=atoms::neighbour_list_end_index[atom]+1;
+
+	switch(AtomExchangeType){
+		case 0:
+			for(int nn=start;nn<end;nn++){
+				const int natom = atoms::neighbour_list_array[nn];
+				const double Jij=atoms::i_exchange_list[atoms::neighbour_interaction_type_array[nn]].Jij;
+				H[0] -= Jij*atoms::x_spin_array[natom];
+				H[1] -= Jij*atoms::y_spin_array[natom];
+				H[2] -= Jij*atoms::z_spin_array[natom];
+			}
+			break;
+		case 1:
+			for(int nn=start;nn<end;nn++){
+				const int natom = atoms::neighbour_list_array[nn];
+				const int iid = atoms::neighbour_interaction_type_array[nn];
+				H[0] -= atoms::v_exchange_list[iid].Jij[0]*atoms::x_spin_array[natom];
+				H[1] -= atoms::v_exchange_list[iid].Jij[1]*atoms::y_spin_array[natom];
+				H[2] -= atoms::v_exchange_list[iid].Jij[2]*atoms::z_spin_array[natom];
+			}
+			break;
+		case 2:
+			for(int nn=start;nn<end;nn++){
+				const int natom = atoms::neighbour_list_array[nn];
+				const int iid = atoms::neighbour_interaction_type_array[nn];
+				const double S[3]={atoms::x_spin_array[natom],atoms::y_spin_array[natom],atoms::z_spin_array[natom]};
+				H[0] -= atoms::t_exchange_list[iid].Jij[0][0]*S[0] + atoms::t_exchange_list[iid].Jij[0][1]*S[1] + atoms::t_exchange_list[iid].Jij[0][2]*S[2];
+				H[1] -= atoms::t_exchange_list[iid].Jij[1][0]*S[0] + atoms::t_exchange_list[iid].Jij[1][1]*S[1] + atoms::t_exchange_list[iid].Jij[1][2]*S[2];
+				H[2] -= atoms::t_exchange_list[iid].Jij[2][0]*S[0] + atoms::t_exchange_list[iid].Jij[2][1]*S[1] + atoms::t_exchange_list[iid].Jij[2][2]*S[2];
+			}
+			break;
+		default: zlog << zTs() << "Error. atoms::exchange_type has value " << AtomExchangeType << " which is outside of valid range 0-2. Exiting." << std::endl; err::vexit();
+	}
+
+	return;
+}
+
+/// @brief Calculates the change in anisotropy energy for a single spin move.
+///
+/// @details The uniaxial term is evaluated directly from the difference,
+///          K(Sz'-Sz)(Sz'+Sz); the remaining single ion terms are closed
+///          form expressions of the local spin only and are differenced.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    20/03/2012
+///
+/// @param[in] atom atom number
+/// @param[in] imaterial material of local atom
+/// @param[in] Sold initial spin direction
+/// @param[in] Snew final spin direction
+/// @return anisotropy energy difference (Tesla)
+///
+/// @internal
+///	Created:		20/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+double spin_anisotropy_energy_difference(const int atom, const int imaterial, const double Sold[3], const double Snew[3]){
+
+	double dE=0.0;
+
+	switch(sim::AnisotropyType){
+		case 0: dE+=mp::MaterialScalarAnisotropyArray[imaterial].K*(Snew[2]-Sold[2])*(Snew[2]+Sold[2]); break;
+		case 1: dE+=spin_tensor_anisotropy_energy(imaterial, Snew[0], Snew[1], Snew[2])
+					  -spin_tensor_anisotropy_energy(imaterial, Sold[0], Sold[1], Sold[2]); break;
+		case 2: ; break; // skip
+		default: zlog << zTs() << "Error. sim::AnisotropyType has value " << sim::AnisotropyType << " which is outside of valid range 0-1. Exiting." << std::endl; err::vexit();
+	}
+	if(second_order_uniaxial_anisotropy) dE+=spin_second_order_uniaxial_anisotropy_energy(imaterial, Snew[0], Snew[1], Snew[2])
+														 -spin_second_order_uniaxial_anisotropy_energy(imaterial, Sold[0], Sold[1], Sold[2]);
+	if(sixth_order_uniaxial_anisotropy) dE+=spin_sixth_order_uniaxial_anisotropy_energy(imaterial, Snew[0], Snew[1], Snew[2])
+														-spin_sixth_order_uniaxial_anisotropy_energy(imaterial, Sold[0], Sold[1], Sold[2]);
+	if(sim::CubicScalarAnisotropy==true) dE+=spin_cubic_anisotropy_energy(imaterial, Snew[0], Snew[1], Snew[2])
+														 -spin_cubic_anisotropy_energy(imaterial, Sold[0], Sold[1], Sold[2]);
+	if(sim::lattice_anisotropy_flag) dE+=spin_lattice_anisotropy_energy(imaterial, Snew[0], Snew[1], Snew[2])
+													-spin_lattice_anisotropy_energy(imaterial, Sold[0], Sold[1], Sold[2]);
+	if(sim::surface_anisotropy==true) dE+=spin_surface_anisotropy_energy(atom, imaterial, Snew[0], Snew[1], Snew[2])
+													 -spin_surface_anisotropy_energy(atom, imaterial, Sold[0], Sold[1], Sold[2]);
+	if(sim::spherical_harmonics) dE+=spin_spherical_harmonic_aniostropy_energy(imaterial, Snew[0], Snew[1], Snew[2])
+												-spin_spherical_harmonic_aniostropy_energy(imaterial, Sold[0], Sold[1], Sold[2]);
+
+	return dE; // Tesla
+}
+
+/// @brief Calculates the change in total energy for a single spin move.
+///
+/// @details Equivalent to the difference of calculate_spin_energy() before
+///          and after the move, but the neighbour list is traversed only once
+///          and the spin arrays are not modified. The change is given by
+///          dE = -(S'-S).(H_exch + H_app + H_dip) + dE_anis.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    20/03/2012
+///
+/// @param[in] atom atom number
+/// @param[in] AtomExchangeType exchange type (0 isotropic, 1 vector, 2 tensor)
+/// @param[in] Sold initial spin direction
+/// @param[in] Snew final spin direction
+/// @return energy difference (Tesla)
+///
+/// @internal
+///	Created:		20/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+double calculate_spin_energy_difference(const int atom, const int AtomExchangeType, const double Sold[3], const double Snew[3]){
+
+	// check calling of routine if error checking is activated
+	if(err::check==true) std::cout << "calculate_spin_energy_difference has been called" << std::endl;
+
+	// Determine local material
+	const int imaterial=atoms::type_array[atom];
+
+	// Calculate exchange field from neighbours
+	double H[3];
+	spin_exchange_field(atom, AtomExchangeType, H);
+
+	// Add applied and magnetostatic fields
+	H[0]+=sim::H_applied*sim::H_vec[0]+atoms::x_dipolar_field_array[atom];
+	H[1]+=sim::H_applied*sim::H_vec[1]+atoms::y_dipolar_field_array[atom];
+	H[2]+=sim::H_applied*sim::H_vec[2]+atoms::z_dipolar_field_array[atom];
+
+	const double dS[3]={Snew[0]-Sold[0],Snew[1]-Sold[1],Snew[2]-Sold[2]};
 
+	return spin_anisotropy_energy_difference(atom, imaterial, Sold, Snew) - (dS[0]*H[0]+dS[1]*H[1]+dS[2]*H[2]); // Tesla
+}
+
+/// @brief Calculates the total energy of each material.
+///
+/// @details Sums the energy of all local spins of each material, counting
+///          each exchange and dipolar pair once, and reduces the result over
+///          all CPUs. Halo spins are refreshed first so that boundary bonds
+///          see the current state.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    02/04/2012
+///
+/// @param[out] material_energy total energy of each material (Joules)
+///
+/// @internal
+///	Created:		02/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void calculate_material_energy(std::vector<double>& material_energy){
+
+	// check calling of routine if error checking is activated
+	if(err::check==true) std::cout << "calculate_material_energy has been called" << std::endl;
+
+	#ifdef MPICF
+		mpi_init_halo_swap();
+		mpi_complete_halo_swap();
+		const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+	#else
+		const int num_local_atoms = atoms::num_atoms;
+	#endif
+
+	const int AtomExchangeType=atoms::exchange_type;
+
+	material_energy.assign(mp::num_materials,0.0);
+
+	for(int atom=0;atom<num_local_atoms;atom++){
+
+		const int imaterial=atoms::type_array[atom];
+
+		// exchange and dipolar fields to remove double counted half of pair energies
+		double H[3];
+		spin_exchange_field(atom, AtomExchangeType, H);
+		H[0]+=atoms::x_dipolar_field_array[atom];
+		H[1]+=atoms::y_dipolar_field_array[atom];
+		H[2]+=atoms::z_dipolar_field_array[atom];
+		const double SdotH = atoms::x_spin_array[atom]*H[0]+atoms::y_spin_array[atom]*H[1]+atoms::z_spin_array[atom]*H[2];
+
+		material_energy[imaterial]+=(calculate_spin_energy(atom, AtomExchangeType)+0.5*SdotH)*mp::material[imaterial].mu_s_SI;
+	}
+
+	#ifdef MPICF
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&material_energy[0],mp::num_materials,MPI_DOUBLE,MPI_SUM);
+	#endif
+
+	return;
+}
+
+/// @brief Calculates the total energy of the system.
+///
+/// @return total energy (Joules)
+///
+double calculate_system_energy(){
+
+	// check calling of routine if error checking is activated
+	if(err::check==true) std::cout << "calculate_system_energy has been called" << std::endl;
+
+	std::vector<double> material_energy;
+	calculate_material_energy(material_energy);
+
+	double energy=0.0;
+	for(int mat=0;mat<mp::num_materials;mat++) energy+=material_energy[mat];
+
+	return energy; // Joules
+}
+
+} // end of namespace sim
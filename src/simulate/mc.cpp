@@ -57,9 +57,103 @@
 #include "material.hpp"
 #include "random.hpp"
 #include "sim.hpp"
+#include "vmpi.hpp"
 
 namespace sim{
 	
+/// @brief Calculates material dependent Monte Carlo parameters
+///
+/// @details Sets the rescaled inverse temperature and the width of the
+///          gaussian trial move for each material. The default width,
+///          pow(kT/mu_B,0.2)*0.08, is multiplied by a per material scaling
+///          which is adjusted during equilibration when adaptive step
+///          widths are enabled.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    10/04/2012
+///
+/// @param[out] rescaled_material_kBTBohr mu_B/kT for each material
+/// @param[out] sigma_array gaussian move width for each material
+///
+/// @internal
+///	Created:		10/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void mc_material_parameters(std::vector<double>& rescaled_material_kBTBohr, std::vector<double>& sigma_array){
+
+	// Initialise step width scaling
+	if(sim::mc_step_width_scaling.size()!=static_cast<unsigned int>(mp::num_materials)) sim::mc_step_width_scaling.resize(mp::num_materials,1.0);
+
+	rescaled_material_kBTBohr.resize(mp::num_materials);
+	sigma_array.resize(mp::num_materials);
+
+	for(int m=0; m<mp::num_materials; ++m){
+		double alpha = mp::material[m].temperature_rescaling_alpha;
+		double Tc = mp::material[m].temperature_rescaling_Tc;
+		double rescaled_temperature = sim::temperature < Tc ? Tc*pow(sim::temperature/Tc,alpha) : sim::temperature;
+		rescaled_material_kBTBohr[m] = 9.27400915e-24/(rescaled_temperature*1.3806503e-23);
+		sigma_array[m] = rescaled_temperature < 1.0 ? 0.02 : pow(1.0/rescaled_material_kBTBohr[m],0.2)*0.08;
+		sigma_array[m] *= sim::mc_step_width_scaling[m];
+	}
+
+	return;
+}
+
+/// @brief Adjusts Monte Carlo step widths towards the target acceptance
+///
+/// @details Only active during equilibration with adaptive step widths
+///          enabled. The scaling for each material is multiplied by the
+///          ratio of measured to target acceptance, limited to a factor of
+///          two per call. Only angle moves depend on the width and are
+///          counted. Counters are reduced over all CPUs so that all
+///          processors use the same width.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    10/04/2012
+///
+/// @param[in] material_moves number of angle moves for each material
+/// @param[in] material_reject number of rejected angle moves for each material
+///
+/// @internal
+///	Created:		10/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void mc_tune_step_width(std::vector<double>& material_moves, std::vector<double>& material_reject){
+
+	if(!sim::mc_adaptive_step_width || !sim::mc_equilibrating) return;
+
+	#ifdef MPICF
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&material_moves[0],mp::num_materials,MPI_DOUBLE,MPI_SUM);
+		MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE,&material_reject[0],mp::num_materials,MPI_DOUBLE,MPI_SUM);
+	#endif
+
+	for(int m=0; m<mp::num_materials; ++m){
+		if(material_moves[m] < 1.0) continue;
+		const double acceptance = 1.0-material_reject[m]/material_moves[m];
+		const double ratio = acceptance/sim::mc_target_acceptance;
+		sim::mc_step_width_scaling[m] *= ratio < 0.5 ? 0.5 : (ratio > 2.0 ? 2.0 : ratio);
+		// limit to sensible range, large widths are equivalent to uniform moves
+		if(sim::mc_step_width_scaling[m] < 1.0e-3) sim::mc_step_width_scaling[m] = 1.0e-3;
+		if(sim::mc_step_width_scaling[m] > 1.0e2) sim::mc_step_width_scaling[m] = 1.0e2;
+	}
+
+	return;
+}
+
 /// @brief Monte Carlo Integrator
 ///
 /// @callgraph
@@ -98,21 +192,19 @@ int MonteCarlo(){
 	// Temporaries
 	int atom=0;
 	double r=1.0;
-	double Eold=0.0;
-	double Enew=0.0;
 	double DE=0.0;
 	const int AtomExchangeType=atoms::exchange_type;
+	const bool use_heat_bath = (sim::mc_algorithm==sim::heat_bath);
 	
-   // Material dependent temperature rescaling
-   std::vector<double> rescaled_material_kBTBohr(mp::num_materials);
-   std::vector<double> sigma_array(mp::num_materials); // range for tuned gaussian random move
-   for(int m=0; m<mp::num_materials; ++m){
-      double alpha = mp::material[m].temperature_rescaling_alpha;
-      double Tc = mp::material[m].temperature_rescaling_Tc;
-      double rescaled_temperature = sim::temperature < Tc ? Tc*pow(sim::temperature/Tc,alpha) : sim::temperature;
-      rescaled_material_kBTBohr[m] = 9.27400915e-24/(rescaled_temperature*1.3806503e-23);
-      sigma_array[m] = rescaled_temperature < 1.0 ? 0.02 : pow(1.0/rescaled_material_kBTBohr[m],0.2)*0.08;
-   }
+   // Material dependent temperature rescaling and move widths
+   std::vector<double> rescaled_material_kBTBohr;
+   std::vector<double> sigma_array; // range for tuned gaussian random move
+   sim::mc_material_parameters(rescaled_material_kBTBohr, sigma_array);
+
+   // Material dependent statistics of angle moves for step width tuning
+   const bool tune = sim::mc_adaptive_step_width && sim::mc_equilibrating;
+   std::vector<double> material_moves(mp::num_materials,0.0);
+   std::vector<double> material_reject(mp::num_materials,0.0);
 
    double statistics_moves = 0.0;
    double statistics_reject = 0.0;
@@ -137,44 +229,40 @@ int MonteCarlo(){
 		Sold[1] = atoms::y_spin_array[atom];
 		Sold[2] = atoms::z_spin_array[atom];
 
-      // Make Monte Carlo move
-      sim::mc_move(Sold, Snew);
-
-		// Calculate current energy
-		Eold = sim::calculate_spin_energy(atom, AtomExchangeType);
-		
-		// Copy new spin position
-		atoms::x_spin_array[atom] = Snew[0];
-		atoms::y_spin_array[atom] = Snew[1];
-		atoms::z_spin_array[atom] = Snew[2];
+		// Draw new spin from local field, correcting for anisotropy only
+		if(use_heat_bath){
+			sim::mc_heat_bath(atom, AtomExchangeType, mp::material[imaterial].mu_s_SI*1.07828231e23*rescaled_material_kBTBohr[imaterial], Snew);
+			DE = sim::spin_anisotropy_energy_difference(atom, imaterial, &Sold[0], &Snew[0])*mp::material[imaterial].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+		}
+		else{
+			// Make Monte Carlo move
+			sim::mc_move(Sold, Snew);
 
-		// Calculate new energy
-		Enew = sim::calculate_spin_energy(atom, AtomExchangeType);
-		
-		// Calculate difference in Joules/mu_B
-		DE = (Enew-Eold)*mp::material[imaterial].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+			// Calculate difference in Joules/mu_B
+			DE = sim::calculate_spin_energy_difference(atom, AtomExchangeType, &Sold[0], &Snew[0])*mp::material[imaterial].mu_s_SI*1.07828231e23; //1/9.27400915e-24
+		}
 		
-		// Check for lower energy state and accept unconditionally
-		if(DE<0) continue;
-		// Otherwise evaluate probability for move
+		// Accept lower energy states unconditionally, otherwise evaluate probability for move
+		if(DE<0 || exp(-DE*rescaled_material_kBTBohr[imaterial]) >= mtrandom::grnd()){
+			atoms::x_spin_array[atom] = Snew[0];
+			atoms::y_spin_array[atom] = Snew[1];
+			atoms::z_spin_array[atom] = Snew[2];
+		}
+		// add one to rejection counter
 		else{
-			if(exp(-DE*rescaled_material_kBTBohr[imaterial]) >= mtrandom::grnd()) continue;
-			// If rejected reset spin coordinates and continue
-			else{
-				atoms::x_spin_array[atom] = Sold[0];
-				atoms::y_spin_array[atom] = Sold[1];
-				atoms::z_spin_array[atom] = Sold[2];
-            // add one to rejection counter
-            statistics_reject += 1.0;
-				continue;
-			}
+			statistics_reject += 1.0;
+			if(tune && sim::mc_last_move_angle) material_reject[imaterial] += 1.0;
 		}
+		if(tune && sim::mc_last_move_angle) material_moves[imaterial] += 1.0;
 	}
 	
    // Save statistics to sim namespace variable
    sim::mc_statistics_moves += statistics_moves;
    sim::mc_statistics_reject += statistics_reject;
 
+   // Adjust step widths during equilibration
+   if(tune) sim::mc_tune_step_width(material_moves, material_reject);
+
 	return EXIT_SUCCESS;
 }
 
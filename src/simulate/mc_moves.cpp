@@ -32,11 +32,14 @@
 //
 //-------------------------------------------------------------------
 // standard library header files
+#include <cmath>
 #include <valarray>
 
 // vampire header files
+#include "atoms.hpp"
 #include "random.hpp"
 #include "sim.hpp"
+#include "vio.hpp"
 
 namespace sim{
 
@@ -47,6 +50,9 @@ void mc_uniform(const std::valarray<double>&, std::valarray<double>&);
 void mc_angle(const std::valarray<double>&, std::valarray<double>&);
 void mc_hinzke_nowak(const std::valarray<double>&, std::valarray<double>&);
 
+// Flag to log fallback from heat-bath moves only once
+bool heat_bath_fallback_logged=false;
+
 ///--------------------------------------------------------
 ///
 ///  Master function to call desired Monte Carlo move
@@ -58,6 +64,9 @@ void mc_move(const std::valarray<double>& old_spin, std::valarray<double>& new_s
    using namespace sim;
    //enum mc_algorithms { spin_flip, uniform, angle, hinzke_nowak};
 
+   // Reset move type, set by angle move
+   sim::mc_last_move_angle=false;
+
    // Select algorithm using case statement
    switch(sim::mc_algorithm){
       
@@ -73,6 +82,15 @@ void mc_move(const std::valarray<double>& old_spin, std::valarray<double>& new_s
       case hinzke_nowak:
          mc_hinzke_nowak(old_spin, new_spin);
          break;
+      // heat bath needs the local field and is handled by the Monte Carlo
+      // integrator, other callers fall back to the default move
+      case heat_bath:
+         if(heat_bath_fallback_logged==false){
+            zlog << zTs() << "Warning - heat-bath moves are only supported by the monte-carlo integrator, using hinzke-nowak moves instead" << std::endl;
+            heat_bath_fallback_logged=true;
+         }
+         mc_hinzke_nowak(old_spin, new_spin);
+         break;
       default:
          mc_hinzke_nowak(old_spin, new_spin);
          break;
@@ -84,6 +102,8 @@ void mc_move(const std::valarray<double>& old_spin, std::valarray<double>& new_s
 /// Move spin within cone near old position
 void mc_angle(const std::valarray<double>& old_spin, std::valarray<double>& new_spin){
 
+   sim::mc_last_move_angle=true;
+
    new_spin[0]=old_spin[0]+mtrandom::gaussian()*sim::mc_delta_angle;
    new_spin[1]=old_spin[1]+mtrandom::gaussian()*sim::mc_delta_angle;
    new_spin[2]=old_spin[2]+mtrandom::gaussian()*sim::mc_delta_angle;
@@ -155,5 +175,70 @@ void mc_hinzke_nowak(const std::valarray<double>& old_spin, std::valarray<double
       return;
 }
 
+/// Heat bath move
+/// Draw new spin from the Boltzmann distribution P(S) ~ exp(beta S.H) in
+/// the local exchange, applied and magnetostatic field H (Tesla), where
+/// beta = mu_s/kT (1/Tesla). The move does not depend on the old spin and
+/// is always accepted for these terms; anisotropy must be included by the
+/// caller with a Metropolis correction. At zero temperature the spin is
+/// aligned with the local field.
+///
+/// Y. Miyatake et al, J. Phys. C: Solid State Phys. 19, 2539 (1986)
+///
+void mc_heat_bath(const int atom, const int AtomExchangeType, const double beta, std::valarray<double>& new_spin){
+
+   // Calculate local field
+   double H[3];
+   sim::spin_exchange_field(atom, AtomExchangeType, H);
+   H[0]+=sim::H_applied*sim::H_vec[0]+atoms::x_dipolar_field_array[atom];
+   H[1]+=sim::H_applied*sim::H_vec[1]+atoms::y_dipolar_field_array[atom];
+   H[2]+=sim::H_applied*sim::H_vec[2]+atoms::z_dipolar_field_array[atom];
+
+   // Heat bath move is not an angle move
+   sim::mc_last_move_angle=false;
+
+   const double Hmod = sqrt(H[0]*H[0]+H[1]*H[1]+H[2]*H[2]);
+
+   // Zero or negligible field, distribution is uniform on unit sphere (checking
+   // Hmod first avoids a = 0*inf at zero temperature)
+   if(Hmod == 0.0 || beta*Hmod < 1.0e-10){
+      mc_uniform(new_spin, new_spin);
+      return;
+   }
+   const double a = beta*Hmod;
+
+   // Sample cos(theta) from P(u) ~ exp(a u), u = [-1:1], by inversion,
+   // with u = 1 for infinite a at zero temperature
+   double u = 1.0;
+   if(a < 1.0e300){
+      const double r = mtrandom::grnd();
+      u = 1.0 + log(r + (1.0-r)*exp(-2.0*a))/a;
+      if(u < -1.0) u = -1.0;
+   }
+   const double s = sqrt(1.0-u*u);
+   const double phi = 2.0*M_PI*mtrandom::grnd();
+
+   // Set up orthonormal basis (e1, e2, h) with h along local field
+   const double h[3] = {H[0]/Hmod, H[1]/Hmod, H[2]/Hmod};
+   double e1[3];
+   if(fabs(h[0]) < 0.9){ e1[0] = 0.0; e1[1] = h[2]; e1[2] = -h[1]; } // h x (1,0,0)
+   else{ e1[0] = -h[2]; e1[1] = 0.0; e1[2] = h[0]; } // h x (0,1,0)
+   const double e1mod = 1.0/sqrt(e1[0]*e1[0]+e1[1]*e1[1]+e1[2]*e1[2]);
+   e1[0]*=e1mod;
+   e1[1]*=e1mod;
+   e1[2]*=e1mod;
+   const double e2[3] = {h[1]*e1[2]-h[2]*e1[1], h[2]*e1[0]-h[0]*e1[2], h[0]*e1[1]-h[1]*e1[0]};
+
+   const double c1 = s*cos(phi);
+   const double c2 = s*sin(phi);
+
+   new_spin[0] = c1*e1[0] + c2*e2[0] + u*h[0];
+   new_spin[1] = c1*e1[1] + c2*e2[1] + u*h[1];
+   new_spin[2] = c1*e1[2] + c2*e2[2] + u*h[2];
+
+   return;
+
+}
+
 }
 
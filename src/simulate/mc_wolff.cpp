@@ -0,0 +1,205 @@
+//-----------------------------------------------------------------------------
+//
+//  Vampire - A code for atomistic simulation of magnetic materials
+//
+//  Copyright (C) 2009-2012 R.F.L.Evans
+//
+//  Email:richard.evans@york.ac.uk
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//  General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software Foundation,
+//  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+// ----------------------------------------------------------------------------
+//
+///
+/// @file
+/// @brief Contains the Wolff cluster Monte Carlo integrator
+///
+/// @details Clusters are grown using the embedded Ising variables of the
+///          isotropic exchange, sigma_i = sign(r.S_i), for a random mirror
+///          plane with normal r. All spins in a cluster are then reflected,
+///          S -> S - 2(r.S)r. Single ion anisotropy, applied and
+///          magnetostatic fields are not part of the embedding, so each
+///          cluster flip is accepted with the Metropolis probability of
+///          their energy change, and every step finishes with a normal
+///          single spin Monte Carlo sweep.
+///
+/// @section notes Implementation Notes
+/// U. Wolff, Phys. Rev. Lett. 62, 361 (1989)
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section info File Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    27/03/2012
+/// @internal
+///	Created:		27/03/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+
+// Standard Libraries
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+
+namespace wolff{
+
+   bool initialised=false;
+   std::vector<bool> in_cluster; // flag for atoms already in cluster
+   std::vector<int> cluster;     // list of atoms in current cluster
+   std::vector<double> cluster_projection; // r.S of cluster atoms before reflection
+
+} // end of namespace wolff
+
+namespace sim{
+
+/// @brief Wolff cluster Monte Carlo Integrator
+///
+/// @details Performs cluster updates until on average every spin has been
+///          considered once, followed by a single spin Monte Carlo step.
+///          Only isotropic exchange can be embedded.
+///
+/// @return EXIT_SUCCESS
+///
+int WolffMonteCarlo(){
+
+   // Check for calling of function
+   if(err::check==true) std::cout << "sim::WolffMonteCarlo has been called" << std::endl;
+
+   using namespace wolff;
+
+   // Check for initialisation of cluster arrays
+   if(initialised==false){
+      if(atoms::exchange_type!=0){
+         terminaltextcolor(RED);
+         std::cerr << "Error - Wolff cluster Monte Carlo requires isotropic exchange" << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Error - Wolff cluster Monte Carlo requires isotropic exchange, exchange type is " << atoms::exchange_type << std::endl;
+         err::vexit();
+      }
+      in_cluster.resize(atoms::num_atoms,false);
+      cluster.reserve(atoms::num_atoms);
+      cluster_projection.reserve(atoms::num_atoms);
+      initialised=true;
+   }
+
+   // Material dependent temperature rescaling
+   std::vector<double> rescaled_material_kBTBohr;
+   std::vector<double> sigma_array;
+   sim::mc_material_parameters(rescaled_material_kBTBohr, sigma_array);
+
+   const int num_atoms = atoms::num_atoms;
+   int num_considered = 0;
+
+   // Grow and flip clusters until every spin has been considered once on average
+   while(num_considered < num_atoms){
+
+      // pick random mirror plane
+      double r[3] = {mtrandom::gaussian(), mtrandom::gaussian(), mtrandom::gaussian()};
+      const double rmod = 1.0/sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+      r[0]*=rmod;
+      r[1]*=rmod;
+      r[2]*=rmod;
+
+      // pick seed atom
+      const int seed = int(num_atoms*mtrandom::grnd());
+
+      cluster.resize(0);
+      cluster_projection.resize(0);
+      cluster.push_back(seed);
+      cluster_projection.push_back(r[0]*atoms::x_spin_array[seed]+r[1]*atoms::y_spin_array[seed]+r[2]*atoms::z_spin_array[seed]);
+      in_cluster[seed]=true;
+
+      // Energy change of terms not included in the embedding (units of kT)
+      double DE = 0.0;
+
+      // Grow cluster, reflecting each spin as it is added
+      for(unsigned int c=0; c<cluster.size(); c++){
+
+         const int atom = cluster[c];
+         const int imaterial = atoms::type_array[atom];
+         const double projection = cluster_projection[c];
+         const double beta = mp::material[imaterial].mu_s_SI*1.07828231e23*rescaled_material_kBTBohr[imaterial];
+
+         // reflect spin in mirror plane
+         const double Sold[3] = {atoms::x_spin_array[atom], atoms::y_spin_array[atom], atoms::z_spin_array[atom]};
+         const double Snew[3] = {Sold[0]-2.0*projection*r[0], Sold[1]-2.0*projection*r[1], Sold[2]-2.0*projection*r[2]};
+         atoms::x_spin_array[atom] = Snew[0];
+         atoms::y_spin_array[atom] = Snew[1];
+         atoms::z_spin_array[atom] = Snew[2];
+
+         // Single ion, applied and magnetostatic energy change
+         const double dS[3] = {Snew[0]-Sold[0], Snew[1]-Sold[1], Snew[2]-Sold[2]};
+         DE += beta*(sim::spin_anisotropy_energy_difference(atom, imaterial, Sold, Snew)
+                    -(dS[0]*(sim::H_applied*sim::H_vec[0]+atoms::x_dipolar_field_array[atom])
+                     +dS[1]*(sim::H_applied*sim::H_vec[1]+atoms::y_dipolar_field_array[atom])
+                     +dS[2]*(sim::H_applied*sim::H_vec[2]+atoms::z_dipolar_field_array[atom])));
+
+         // Activate bonds to neighbours with p = 1 - exp(min(0, 2 beta Jij (r.Si)(r.Sj)))
+         for(int nn=atoms::neighbour_list_start_index[atom];nn<=atoms::neighbour_list_end_index[atom];nn++){
+            const int natom = atoms::neighbour_list_array[nn];
+            if(in_cluster[natom]) continue;
+            const double Jij = atoms::i_exchange_list[atoms::neighbour_interaction_type_array[nn]].Jij;
+            const double nprojection = r[0]*atoms::x_spin_array[natom]+r[1]*atoms::y_spin_array[natom]+r[2]*atoms::z_spin_array[natom];
+            const double x = 2.0*beta*Jij*projection*nprojection;
+            if(x < 0.0 && mtrandom::grnd() < 1.0-exp(x)){
+               cluster.push_back(natom);
+               cluster_projection.push_back(nprojection);
+               in_cluster[natom]=true;
+            }
+         }
+      }
+
+      const int cluster_size = cluster.size();
+      num_considered += cluster_size;
+      sim::wolff_statistics_clusters += 1.0;
+      sim::wolff_statistics_flipped += double(cluster_size);
+
+      // Accept or reject cluster flip against non-embedded energy terms
+      const bool accept = (DE < 0.0 || exp(-DE) >= mtrandom::grnd());
+      if(!accept) sim::wolff_statistics_reject += 1.0;
+
+      for(int c=0; c<cluster_size; c++){
+         const int atom = cluster[c];
+         in_cluster[atom]=false;
+         if(!accept){
+            // reflection is its own inverse
+            const double p = -cluster_projection[c];
+            atoms::x_spin_array[atom] -= 2.0*p*r[0];
+            atoms::y_spin_array[atom] -= 2.0*p*r[1];
+            atoms::z_spin_array[atom] -= 2.0*p*r[2];
+         }
+      }
+   }
+
+   // Metropolis sweep for single ion and field terms
+   sim::MonteCarlo();
+
+   return EXIT_SUCCESS;
+}
+
+} // End of namespace sim
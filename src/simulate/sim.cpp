@@ -42,6 +42,8 @@
 
 // Vampire Header files
 #include "atoms.hpp"
+#include "cells.hpp"
+#include "create.hpp"
 #include "program.hpp"
 #include "demag.hpp"
 #include "errors.hpp"
@@ -97,6 +99,9 @@ namespace sim{
 	double constraint_theta_min=0.0; /// loop angle min [degrees]
 	double constraint_theta_max=0.0; // loop angle max [degrees]
 	double constraint_theta_delta=5.0; /// loop angle delta [degrees]
+
+	int constraint_sweep_workers=1; /// number of independent runs sharing angle sweep
+	int constraint_sweep_worker=0; /// index of this run in angle sweep
 	
 	// LaGrange multiplier variables
 	double lagrange_lambda_x=0.0;
@@ -123,11 +128,23 @@ namespace sim{
 	double TTTp = 0.0; /// phonon temperature
   
    double mc_delta_angle=0.1; /// Tuned angle for Monte Carlo trial move
+   bool mc_last_move_angle=false; /// True if last trial move was an angle move
    mc_algorithms mc_algorithm=hinzke_nowak;
+   bool mc_adaptive_step_width=false; /// Tune Monte Carlo step width during equilibration
+   double mc_target_acceptance=0.5; /// Target acceptance ratio for tuned step width
+   bool mc_equilibrating=false; /// Set while the system is being equilibrated
+   std::vector<double> mc_step_width_scaling; /// Tuned scaling of step width for each material
+
+   int wang_landau_bins=100; /// Number of energy bins for density of states
+   int wang_landau_windows=1; /// Number of overlapping energy windows
+   double wang_landau_flatness=0.8; /// Minimum ratio of smallest to mean histogram entry
+   double wang_landau_final_modification_factor=1.0e-6; /// Final value of ln f
+   int wang_landau_maximum_sweeps=10000000; /// Maximum sweeps to reach window or flat histogram
   
 	int system_simulation_flags;
 	int hamiltonian_simulation_flags[10];
-	int integrator=0; /// 0 = LLG Heun; 1= MC; 2 = LLG Midpoint; 3 = CMC 
+	int integrator=0; /// 0 = LLG Heun; 1= MC; 2 = LLG Midpoint; 3 = CMC; 4 = hybrid CMC; 5 = Wolff MC
+	bool integrator_statistics=false; /// accumulate statistics and cell magnetisation in final LLG sweep
 	int program=0; 
 	int AnisotropyType=2; /// Controls scalar (0) or tensor(1) anisotropy (off(2))
 
@@ -167,6 +184,11 @@ namespace sim{
    double mc_statistics_moves = 0.0;
    double mc_statistics_reject = 0.0;
 
+   // Wolff cluster Monte Carlo statistics counters
+   double wolff_statistics_clusters = 0.0;
+   double wolff_statistics_flipped = 0.0;
+   double wolff_statistics_reject = 0.0;
+
 /// @brief Function to increment time counter and associted variables
 ///
 /// @section License
@@ -191,6 +213,66 @@ namespace sim{
 		sim::head_position[0]+=sim::head_speed*mp::dt_SI*1.0e10;
 		if(sim::hamiltonian_simulation_flags[4]==1) demag::update();
 		if(sim::lagrange_multiplier) update_lagrange_lambda();
+		if(stats::calculate_structure_factor==true && sim::time%stats::structure_factor_rate==0){
+			stats::structure_factor.calculate(atoms::x_spin_array, atoms::y_spin_array, atoms::z_spin_array);
+		}
+	}
+
+/// @brief Function to enable accumulation of statistics during the next integrator step
+///
+/// @details Magnetisation statistics are accumulated on the last step of an
+///          integration, and cell magnetisations on steps followed by a demag
+///          field update, saving a separate pass over the spin arrays.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    07/05/2012
+///
+/// @internal
+///	Created:		07/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+	void begin_sweep(const bool last_step){
+
+		if(sim::integrator_statistics==false) return;
+
+		if(last_step==true) stats::begin_sweep(atoms::m_spin_array);
+
+		if(sim::hamiltonian_simulation_flags[4]==1 && demag::atomistic==false){
+			if((sim::time+1)%demag::update_rate==0) cells::begin_sweep();
+		}
+
+	}
+
+/// @brief Function to mark statistics accumulated by integrator as valid for new time
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    07/05/2012
+///
+/// @internal
+///	Created:		07/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+	void end_sweep(){
+
+		if(sim::integrator_statistics==false) return;
+
+		stats::end_sweep(sim::time+1);
+		cells::end_sweep(sim::time+1);
+
 	}
 	
 /// @brief Function to run one a single program
@@ -251,6 +333,11 @@ int run(){
       int num_atoms_for_statistics = atoms::num_atoms;
    #endif
    stats::initialize(num_atoms_for_statistics, mp::num_materials, atoms::m_spin_array, atoms::type_array, atoms::category_array);
+   if(stats::calculate_structure_factor){
+      stats::structure_factor.initialize(num_atoms_for_statistics, atoms::x_supercell_array, atoms::y_supercell_array, atoms::z_supercell_array,
+                                         atoms::uc_id_array, cells::num_atoms_in_unit_cell, atoms::x_coord_array, atoms::y_coord_array,
+                                         atoms::z_coord_array, cs::unit_cell.dimensions, stats::structure_factor_direction);
+   }
 
    // Check for load spin configurations from checkpoint
    if(sim::load_checkpoint_flag) load_checkpoint();
@@ -375,6 +462,30 @@ int run(){
             zlog << "effective-damping..." << std::endl;
          }
          program::effective_damping();
+         break;
+
+      case 15:
+         if(vmpi::my_rank==0){
+            std::cout << "parallel-tempering..." << std::endl;
+            zlog << "parallel-tempering..." << std::endl;
+         }
+         program::parallel_tempering();
+         break;
+
+      case 16:
+         if(vmpi::my_rank==0){
+            std::cout << "wang-landau..." << std::endl;
+            zlog << "wang-landau..." << std::endl;
+         }
+         program::wang_landau();
+         break;
+
+      case 17:
+         if(vmpi::my_rank==0){
+            std::cout << "dynamic-structure-factor..." << std::endl;
+            zlog << "dynamic-structure-factor..." << std::endl;
+         }
+         program::dynamic_structure_factor();
          break;
 
 		case 50:
@@ -395,7 +506,19 @@ int run(){
    //------------------------------------------------
    // Output Monte Carlo statistics if applicable
    //------------------------------------------------
-   if(sim::integrator==1){
+   if(sim::integrator==5){
+      if(vmpi::my_rank==0){
+         std::cout << "Wolff cluster statistics:" << std::endl;
+         std::cout << "\tTotal clusters: " << long(sim::wolff_statistics_clusters) << std::endl;
+         std::cout << "\tMean cluster size: " << sim::wolff_statistics_flipped/sim::wolff_statistics_clusters << std::endl;
+         std::cout << "\t" << ((sim::wolff_statistics_clusters - sim::wolff_statistics_reject)/sim::wolff_statistics_clusters)*100.0 << "% Accepted" << std::endl;
+      }
+      zlog << zTs() << "Wolff cluster statistics:" << std::endl;
+      zlog << zTs() << "\tTotal clusters: " << sim::wolff_statistics_clusters << std::endl;
+      zlog << zTs() << "\tMean cluster size: " << sim::wolff_statistics_flipped/sim::wolff_statistics_clusters << std::endl;
+      zlog << zTs() << "\t" << ((sim::wolff_statistics_clusters - sim::wolff_statistics_reject)/sim::wolff_statistics_clusters)*100.0 << "% Accepted" << std::endl;
+   }
+   if(sim::integrator==1 || sim::integrator==5){
       std::cout << "Monte Carlo statistics:" << std::endl;
       std::cout << "\tTotal moves: " << long(sim::mc_statistics_moves) << std::endl;
       std::cout << "\t" << ((sim::mc_statistics_moves - sim::mc_statistics_reject)/sim::mc_statistics_moves)*100.0 << "% Accepted" << std::endl;
@@ -404,6 +527,11 @@ int run(){
       zlog << zTs() << "\tTotal moves: " << sim::mc_statistics_moves << std::endl;
       zlog << zTs() << "\t" << ((sim::mc_statistics_moves - sim::mc_statistics_reject)/sim::mc_statistics_moves)*100.0 << "% Accepted" << std::endl;
       zlog << zTs() << "\t" << (sim::mc_statistics_reject/sim::mc_statistics_moves)*100.0                              << "% Rejected" << std::endl;
+      if(sim::mc_adaptive_step_width){
+         for(unsigned int m=0; m<sim::mc_step_width_scaling.size(); m++){
+            zlog << zTs() << "\tStep width scaling for material " << m << ": " << sim::mc_step_width_scaling[m] << std::endl;
+         }
+      }
    }
 
 
@@ -420,6 +548,20 @@ int run(){
       zlog << zTs() << "\t" << (cmc::sphere_reject/cmc::mc_total)*100.0 << "% Rejected (Sphere)" << std::endl;
    }
 
+   if(sim::hamiltonian_simulation_flags[4]==1 && demag::update_tolerance>0.0 && demag::statistics_checks>0.0){
+      const double skipped = demag::statistics_checks-demag::statistics_full_updates-demag::statistics_partial_updates;
+      std::cout << "Dipole field update statistics:" << std::endl;
+      std::cout << "\tTotal checks: " << long(demag::statistics_checks) << std::endl;
+      std::cout << "\t" << (demag::statistics_full_updates/demag::statistics_checks)*100.0    << "% Full updates" << std::endl;
+      std::cout << "\t" << (demag::statistics_partial_updates/demag::statistics_checks)*100.0 << "% Partial updates" << std::endl;
+      std::cout << "\t" << (skipped/demag::statistics_checks)*100.0                           << "% Skipped" << std::endl;
+      zlog << zTs() << "Dipole field update statistics:" << std::endl;
+      zlog << zTs() << "\tTotal checks: " << demag::statistics_checks << std::endl;
+      zlog << zTs() << "\t" << (demag::statistics_full_updates/demag::statistics_checks)*100.0    << "% Full updates" << std::endl;
+      zlog << zTs() << "\t" << (demag::statistics_partial_updates/demag::statistics_checks)*100.0 << "% Partial updates" << std::endl;
+      zlog << zTs() << "\t" << (skipped/demag::statistics_checks)*100.0                           << "% Skipped" << std::endl;
+   }
+
 	//program::LLB_Boltzmann();
 
    // optionally save checkpoint file
@@ -467,6 +609,40 @@ int integrate(int n_steps){
 	return EXIT_SUCCESS;
 }
 
+/// @brief Wrapper function to integrate the system during equilibration
+///
+/// @details Calls integrate() with sim::mc_equilibrating set, allowing
+///          Monte Carlo step widths to be tuned. Tuned widths are frozen
+///          on return so that production sampling obeys detailed balance.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author  Richard Evans, richard.evans@york.ac.uk
+/// @version 1.0
+/// @date    10/04/2012
+///
+/// @return EXIT_SUCCESS
+///
+/// @internal
+///	Created:		10/04/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+int equilibrate(int n_steps){
+
+	// Check for calling of function
+	if(err::check==true) std::cout << "sim::equilibrate has been called" << std::endl;
+
+	sim::mc_equilibrating=true;
+	sim::integrate(n_steps);
+	sim::mc_equilibrating=false;
+
+	return EXIT_SUCCESS;
+}
+
 /// @brief Wrapper function to call serial integrators
 ///
 /// @callgraph
@@ -503,7 +679,9 @@ int integrate_serial(int n_steps){
 				#ifdef CUDA
 					sim::LLG_Heun_cuda();
 				#else
+					begin_sweep(ti==n_steps-1);
 					sim::LLG_Heun();
+					end_sweep();
 				#endif
 				// increment time
 				increment_time();
@@ -524,7 +702,9 @@ int integrate_serial(int n_steps){
 				#ifdef CUDA
 					sim::LLG_Midpoint_cuda();
 				#else
+					begin_sweep(ti==n_steps-1);
 					sim::LLG_Midpoint();
+					end_sweep();
 				#endif
 				// increment time
 				increment_time();
@@ -546,6 +726,14 @@ int integrate_serial(int n_steps){
 				increment_time();
 			}
 			break;
+
+		case 5: // Wolff cluster Monte Carlo
+			for(int ti=0;ti<n_steps;ti++){
+				sim::WolffMonteCarlo();
+				// increment time
+				increment_time();
+			}
+			break;
 		
 		default:{
 			std::cerr << "Unknown integrator type "<< sim::integrator << " requested, exiting" << std::endl;
@@ -593,7 +781,9 @@ int integrate_mpi(int n_steps){
 				#ifdef CUDA
 					//sim::LLG_Heun_cuda_mpi();
 				#else
+					begin_sweep(ti==n_steps-1);
 					sim::LLG_Heun_mpi();
+					end_sweep();
 				#endif
 			#endif
 				// increment time
@@ -603,10 +793,9 @@ int integrate_mpi(int n_steps){
 		
 		case 1: // Montecarlo
 			for(int ti=0;ti<n_steps;ti++){
-				terminaltextcolor(RED);
-				std::cerr << "Error - Monte Carlo Integrator unavailable for parallel execution" << std::endl;
-				terminaltextcolor(WHITE);
-				err::vexit();
+			#ifdef MPICF
+				sim::MonteCarlo_mpi();
+			#endif
 				// increment time
 				increment_time();
 			}
@@ -619,7 +808,9 @@ int integrate_mpi(int n_steps){
 				#ifdef CUDA
 					//sim::LLG_Midpoint_cuda_mpi();
 				#else
+					begin_sweep(ti==n_steps-1);
 					sim::LLG_Midpoint_mpi();
+					end_sweep();
 				#endif
 			#endif
 				// increment time
@@ -637,6 +828,17 @@ int integrate_mpi(int n_steps){
 				increment_time();
 			}
 			break;
+
+		case 5: // Wolff cluster Monte Carlo
+			for(int ti=0;ti<n_steps;ti++){
+				terminaltextcolor(RED);
+				std::cerr << "Error - Wolff cluster Monte Carlo Integrator unavailable for parallel execution" << std::endl;
+				terminaltextcolor(WHITE);
+				err::vexit();
+				// increment time
+				increment_time();
+			}
+			break;
 			
 		default:{
 			terminaltextcolor(RED);
@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// Vampire headers
+#include "stats.hpp"
+
+namespace stats{
+
+//------------------------------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------------------------------
+convergence_statistic_t::convergence_statistic_t (): num_values(0), num_samples(0){}
+
+//------------------------------------------------------------------------------------------------------
+// Function to set number of observables and clear all samples
+//------------------------------------------------------------------------------------------------------
+void convergence_statistic_t::initialize(const int in_num_values){
+
+   num_values = in_num_values;
+   relative_error.assign(num_values,false);
+
+   reset();
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to compare standard error of an observable relative to its magnitude, taken as the larger
+// of the absolute mean and the standard deviation of the samples so that observables with a mean
+// close to zero can still converge
+//------------------------------------------------------------------------------------------------------
+void convergence_statistic_t::set_relative_error(const int id){
+
+   relative_error[id] = true;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to clear all samples for the start of a new sampling window
+//------------------------------------------------------------------------------------------------------
+void convergence_statistic_t::reset(){
+
+   num_samples = 0;
+   block_counter.resize(0);
+   block_mean.resize(0);
+   block_variance.resize(0);
+   pending.resize(0);
+   has_pending.resize(0);
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to add a sample of all observables
+//
+//    Samples are accumulated at level 0 and successive pairs are averaged into blocks at the next
+//    level, so that level l holds N/2^l blocks of 2^l consecutive samples. Block means and variances
+//    are accumulated on the fly (Welford), requiring O(log N) storage for N samples.
+//
+//------------------------------------------------------------------------------------------------------
+void convergence_statistic_t::add(const std::vector<double>& values){
+
+   std::vector<double> block(values.begin(), values.begin()+num_values);
+
+   num_samples++;
+
+   for(unsigned int level=0; ; ++level){
+
+      // add new level if required
+      if(level==block_counter.size()){
+         block_counter.push_back(0.0);
+         block_mean.push_back(std::vector<double>(num_values,0.0));
+         block_variance.push_back(std::vector<double>(num_values,0.0));
+         pending.push_back(std::vector<double>(num_values,0.0));
+         has_pending.push_back(false);
+      }
+
+      // accumulate block at this level
+      block_counter[level]+=1.0;
+      for(int id=0; id<num_values; ++id){
+         const double delta = block[id] - block_mean[level][id];
+         block_mean[level][id] += delta/block_counter[level];
+         block_variance[level][id] += delta*(block[id] - block_mean[level][id]);
+      }
+
+      // store first of pair and wait for partner
+      if(!has_pending[level]){
+         pending[level] = block;
+         has_pending[level] = true;
+         break;
+      }
+
+      // combine pair into block for next level
+      for(int id=0; id<num_values; ++id) block[id] = 0.5*(pending[level][id] + block[id]);
+      has_pending[level] = false;
+
+   }
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate naive standard error of the mean from blocks at a given level
+//------------------------------------------------------------------------------------------------------
+double convergence_statistic_t::block_standard_error(const int level, const int id){
+
+   const double n = block_counter[level];
+   if(n < 2.0) return 0.0;
+
+   return sqrt(block_variance[level][id]/(n*(n-1.0)));
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate mean of an observable
+//------------------------------------------------------------------------------------------------------
+double convergence_statistic_t::get_mean(const int id){
+
+   if(num_samples==0) return 0.0;
+
+   return block_mean[0][id];
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate standard deviation of the samples of an observable
+//------------------------------------------------------------------------------------------------------
+double convergence_statistic_t::get_standard_deviation(const int id){
+
+   if(num_samples < 2) return 0.0;
+
+   return sqrt(block_variance[0][id]/(block_counter[0]-1.0));
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to estimate standard error of the mean of an observable
+//
+//    The naive error of correlated samples is an underestimate which grows with block size until
+//    the blocks are longer than the correlation time. The largest error from levels with at least
+//    minimum_blocks blocks is taken as the estimate.
+//
+//------------------------------------------------------------------------------------------------------
+double convergence_statistic_t::get_standard_error(const int id){
+
+   double error = 0.0;
+
+   for(unsigned int level=0; level<block_counter.size(); ++level){
+      if(block_counter[level] < double(minimum_blocks)) break;
+      const double level_error = block_standard_error(level,id);
+      if(level_error > error) error = level_error;
+   }
+
+   return error;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to estimate integrated autocorrelation time of an observable in samples
+//
+//       tau_int = 1/2 (sigma_block / sigma_0)^2
+//
+//------------------------------------------------------------------------------------------------------
+double convergence_statistic_t::get_autocorrelation_time(const int id){
+
+   if(num_samples < 2) return 0.0;
+
+   const double naive_error = block_standard_error(0,id);
+   if(naive_error == 0.0) return 0.5;
+
+   const double ratio = get_standard_error(id)/naive_error;
+
+   return 0.5*ratio*ratio;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to get number of samples in current window
+//------------------------------------------------------------------------------------------------------
+int convergence_statistic_t::get_num_samples(){
+
+   return num_samples;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to determine if standard errors of all observables are below target
+//------------------------------------------------------------------------------------------------------
+bool convergence_statistic_t::is_converged(const double target_error, const int minimum_samples){
+
+   if(num_samples < minimum_samples || num_samples < 2*minimum_blocks) return false;
+
+   for(int id=0; id<num_values; ++id){
+      const double scale = relative_error[id] ? std::max(fabs(get_mean(id)), get_standard_deviation(id)) : 1.0;
+      if(get_standard_error(id) > target_error*scale) return false;
+   }
+
+   return true;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to output standard errors of all observables as string
+//------------------------------------------------------------------------------------------------------
+std::string convergence_statistic_t::output_standard_error(){
+
+   // result string stream
+   std::ostringstream result;
+
+   for(int id=0; id<num_values; ++id) result << get_standard_error(id) << "\t";
+
+   return result.str();
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to output autocorrelation times of all observables as string
+//------------------------------------------------------------------------------------------------------
+std::string convergence_statistic_t::output_autocorrelation_time(){
+
+   // result string stream
+   std::ostringstream result;
+
+   for(int id=0; id<num_values; ++id) result << get_autocorrelation_time(id) << "\t";
+
+   return result.str();
+
+}
+
+} // end of namespace stats
@@ -8,6 +8,7 @@
 //-----------------------------------------------------------------------------
 
 // C++ standard library headers
+#include <cstddef>
 
 // Vampire headers
 #include "stats.hpp"
@@ -19,6 +20,19 @@ namespace stats{
    bool calculate_height_magnetization          = false;
    bool calculate_material_height_magnetization = false;
    bool calculate_system_susceptibility         = false;
+   bool calculate_histogram_reweighting         = false;
+   bool calculate_convergence                   = false;
+   bool calculate_structure_factor              = false;
+
+   int histogram_reweighting_points = 100;
+
+   double convergence_target_error = 1.0e-3;
+   int convergence_minimum_samples = 64;
+
+   int structure_factor_rate = 1;
+   int structure_factor_direction = 0;
+
+   std::string dynamic_structure_factor_file = "";
 
    magnetization_statistic_t system_magnetization;
    magnetization_statistic_t material_magnetization;
@@ -27,6 +41,20 @@ namespace stats{
 
    susceptibility_statistic_t system_susceptibility;
 
+   reweighting_statistic_t histogram_reweighting;
+
+   convergence_statistic_t convergence;
+   structure_factor_statistic_t structure_factor;
+
+   bool sweep_active = false;
+   bool sweep_valid = false;
+   uint64_t sweep_time = 0;
+   int sweep_num_statistics = 0;
+   std::vector<int> sweep_offset;
+   std::vector<const int*> sweep_mask;
+   std::vector<double> sweep_magnetization;
+   const double* sweep_moment = NULL;
+
    //-----------------------------------------------------------------------------
    // Shared variables used for statistics calculation
    //-----------------------------------------------------------------------------
@@ -0,0 +1,265 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Vampire headers
+#include "errors.hpp"
+#include "stats.hpp"
+#include "vio.hpp"
+#include "vmath.hpp"
+#include "vmpi.hpp"
+
+namespace stats{
+
+//------------------------------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------------------------------
+dynamic_structure_factor_statistic_t::dynamic_structure_factor_statistic_t (): initialized(false), num_atoms(0), num_q_points(0),
+                                                                             num_samples(0), sample_counter(0), sample_time(0.0){}
+
+//------------------------------------------------------------------------------------------------------
+// Function to initialize data structures
+//
+//    Only the complex spin amplitudes at each q point are stored for each sample, requiring
+//    48 bytes per q point per sample on the root process instead of full spin configurations.
+//
+//------------------------------------------------------------------------------------------------------
+void dynamic_structure_factor_statistic_t::initialize(const int in_num_atoms,
+                                                      const std::vector<double>& x, // atomic coordinates (A)
+                                                      const std::vector<double>& y,
+                                                      const std::vector<double>& z,
+                                                      const std::string q_point_file,
+                                                      const double cell_size[3],
+                                                      const int in_num_samples,
+                                                      const double in_sample_time){
+
+   num_atoms = in_num_atoms;
+   num_samples = in_num_samples;
+   sample_time = in_sample_time;
+   sample_counter = 0;
+
+   read_q_points(q_point_file, cell_size);
+
+   // Store local atomic coordinates
+   coordinates.resize(3*num_atoms);
+   for(int atom=0; atom<num_atoms; ++atom){
+      coordinates[3*atom+0] = x[atom];
+      coordinates[3*atom+1] = y[atom];
+      coordinates[3*atom+2] = z[atom];
+   }
+
+   num_atoms_total = double(num_atoms);
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &num_atoms_total, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   amplitude.assign(6*num_q_points,0.0);
+
+   // time series is only stored on root process
+   if(vmpi::my_rank==0){
+      time_series.assign(6*num_q_points*num_samples,0.0);
+
+      // Print memory requirements to log
+      const double memory = 8.0*double(time_series.size())/1.0e6;
+      zlog << zTs() << "Dynamic structure factor calculation enabled for " << num_q_points << " q points and " << num_samples
+           << " samples and requires " << memory << " MB of RAM" << std::endl;
+   }
+
+   initialized = true;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to read list of q points from file
+//
+//    Each line contains h k l in reciprocal lattice units, q = 2 pi (h/a_x, k/a_y, l/a_z).
+//    Blank lines and lines starting with # are ignored.
+//
+//------------------------------------------------------------------------------------------------------
+void dynamic_structure_factor_statistic_t::read_q_points(const std::string filename, const double cell_size[3]){
+
+   std::ifstream qfile(filename.c_str());
+
+   if(!qfile.is_open()){
+      terminaltextcolor(RED);
+      std::cerr << "Error - unable to open dynamic structure factor q point file " << filename << ". Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - unable to open dynamic structure factor q point file " << filename << ". Exiting." << std::endl;
+      err::vexit();
+   }
+
+   q_points.resize(0);
+
+   std::string line;
+   int line_counter = 0;
+   while(getline(qfile,line)){
+
+      line_counter++;
+
+      // skip blank lines and comments
+      const size_t first = line.find_first_not_of(" \t\r");
+      if(first==std::string::npos || line[first]=='#') continue;
+
+      std::istringstream stream(line);
+      double hkl[3];
+      if(!(stream >> hkl[0] >> hkl[1] >> hkl[2])){
+         terminaltextcolor(RED);
+         std::cerr << "Error - expected three values h k l on line " << line_counter << " of dynamic structure factor q point file " << filename << ". Exiting." << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Error - expected three values h k l on line " << line_counter << " of dynamic structure factor q point file " << filename << ". Exiting." << std::endl;
+         err::vexit();
+      }
+
+      for(int i=0; i<3; ++i) q_points.push_back(2.0*M_PI*hkl[i]/cell_size[i]);
+
+   }
+
+   num_q_points = q_points.size()/3;
+
+   if(num_q_points==0){
+      terminaltextcolor(RED);
+      std::cerr << "Error - no q points found in dynamic structure factor q point file " << filename << ". Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - no q points found in dynamic structure factor q point file " << filename << ". Exiting." << std::endl;
+      err::vexit();
+   }
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to add spin amplitudes of current configuration to time series
+//
+//       S(q,t) = sum_i S_i(t) exp(-i q.r_i)
+//
+//------------------------------------------------------------------------------------------------------
+void dynamic_structure_factor_statistic_t::calculate(const std::vector<double>& sx, // spin unit vector
+                                                     const std::vector<double>& sy,
+                                                     const std::vector<double>& sz){
+
+   if(!initialized || sample_counter>=num_samples) return;
+
+   for(int id=0; id<6*num_q_points; ++id) amplitude[id] = 0.0;
+
+   // Project spins onto q points
+   for(int atom=0; atom<num_atoms; ++atom){
+      const double rx = coordinates[3*atom+0];
+      const double ry = coordinates[3*atom+1];
+      const double rz = coordinates[3*atom+2];
+      const double s[3] = {sx[atom], sy[atom], sz[atom]};
+      for(int q=0; q<num_q_points; ++q){
+         const double phase = -(q_points[3*q+0]*rx + q_points[3*q+1]*ry + q_points[3*q+2]*rz);
+         const double c = cos(phase);
+         const double sn = sin(phase);
+         for(int i=0; i<3; ++i){
+            amplitude[6*q+2*i+0] += s[i]*c;
+            amplitude[6*q+2*i+1] += s[i]*sn;
+         }
+      }
+   }
+
+   // Reduce amplitudes on root process, which alone stores time series
+   #ifdef MPICF
+      if(vmpi::my_rank==0) MPI_Reduce(MPI_IN_PLACE, &amplitude[0], 6*num_q_points, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+      else MPI_Reduce(&amplitude[0], &amplitude[0], 6*num_q_points, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+   #endif
+
+   if(vmpi::my_rank==0){
+      const int offset = 6*num_q_points*sample_counter;
+      for(int id=0; id<6*num_q_points; ++id) time_series[offset+id] = amplitude[id];
+   }
+
+   sample_counter++;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to transform time series and output dynamic structure factor to file (root only)
+//
+//       S_aa(q,w) = | sum_t w_t S_a(q,t) exp(-i w t) |^2 / ( N sum_t w_t^2 )
+//
+//    where w_t is a Hann window to reduce spectral leakage. The time series is zero padded to a
+//    power of two, and the mean over all frequencies equals the static structure factor S(q).
+//    Output is a block for each q point of
+//
+//       qx qy qz (1/A)   f (THz)   S_xx   S_yy   S_zz   S
+//
+//    with frequencies from -f_max to f_max, and blocks separated by a blank line.
+//
+//------------------------------------------------------------------------------------------------------
+void dynamic_structure_factor_statistic_t::output(const std::string filename){
+
+   if(vmpi::my_rank!=0 || !initialized) return;
+
+   if(sample_counter<2){
+      zlog << zTs() << "Warning - dynamic structure factor requires at least two samples, no output generated" << std::endl;
+      return;
+   }
+
+   const int num_frequencies = vmath::next_power_of_two(sample_counter);
+
+   // Hann window
+   std::vector<double> window(sample_counter);
+   double window_norm = 0.0;
+   for(int t=0; t<sample_counter; ++t){
+      window[t] = 0.5*(1.0-cos(2.0*M_PI*double(t)/double(sample_counter-1)));
+      window_norm += window[t]*window[t];
+   }
+   const double inorm = 1.0/(num_atoms_total*window_norm);
+
+   std::ofstream ofile(filename.c_str());
+   ofile << "# Dynamic structure factor from " << sample_counter << " samples at intervals of " << sample_time << " s" << std::endl;
+   ofile << "# qx (1/A)\tqy (1/A)\tqz (1/A)\tf (THz)\tSxx\tSyy\tSzz\tS" << std::endl;
+
+   std::vector<std::complex<double> > work(num_frequencies);
+   std::vector<double> spectrum(3*num_frequencies);
+
+   for(int q=0; q<num_q_points; ++q){
+
+      // Transform each spin component
+      for(int i=0; i<3; ++i){
+         for(int t=0; t<num_frequencies; ++t) work[t] = 0.0;
+         for(int t=0; t<sample_counter; ++t){
+            const int id = 6*num_q_points*t + 6*q + 2*i;
+            work[t] = window[t]*std::complex<double>(time_series[id], time_series[id+1]);
+         }
+         vmath::fft(&work[0], num_frequencies, 1, false);
+         for(int f=0; f<num_frequencies; ++f) spectrum[3*f+i] = std::norm(work[f])*inorm;
+      }
+
+      // Output in order of increasing frequency
+      for(int k=0; k<num_frequencies; ++k){
+         const int f = (k+num_frequencies/2)%num_frequencies;
+         const double frequency = double(k-num_frequencies/2)/(double(num_frequencies)*sample_time);
+         ofile << q_points[3*q+0] << "\t" << q_points[3*q+1] << "\t" << q_points[3*q+2] << "\t" << frequency*1.0e-12 << "\t";
+         ofile << spectrum[3*f+0] << "\t" << spectrum[3*f+1] << "\t" << spectrum[3*f+2] << "\t";
+         ofile << spectrum[3*f+0] + spectrum[3*f+1] + spectrum[3*f+2] << std::endl;
+      }
+      ofile << std::endl;
+
+   }
+
+   ofile.close();
+
+   return;
+
+}
+
+} // end of namespace stats
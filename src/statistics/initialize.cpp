@@ -75,6 +75,9 @@ namespace stats{
       // system susceptibility
       if(stats::calculate_system_susceptibility) stats::system_susceptibility.initialize(stats::system_magnetization);
 
+      // histogram reweighting
+      if(stats::calculate_histogram_reweighting) stats::histogram_reweighting.initialize(num_atoms, magnetic_moment_array);
+
       return;
    }
 } // end of namespace stats
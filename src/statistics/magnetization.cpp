@@ -107,23 +107,94 @@ void magnetization_statistic_t::calculate_magnetization(const std::vector<double
                                                          const std::vector<double>& sz,
                                                          const std::vector<double>& mm){
 
-   // initialise magnetization to zero [.end() seems to be optimised away by the compiler...] 
-   std::fill(magnetization.begin(),magnetization.end(),0.0);
+   std::vector<magnetization_statistic_t*> statistics(1,this);
+   stats::calculate_magnetization(statistics,sx,sy,sz,mm);
 
-   // calculate contributions of spins to each magetization category
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate magnetisation for several masks in a single pass over the spins, with a
+// single reduction of all magnetization arrays
+//------------------------------------------------------------------------------------------------------
+void calculate_magnetization(std::vector<magnetization_statistic_t*>& statistics,
+                             const std::vector<double>& sx, // spin unit vector
+                             const std::vector<double>& sy,
+                             const std::vector<double>& sz,
+                             const std::vector<double>& mm){
+
+   const int num_statistics = statistics.size();
+   if(num_statistics==0) return;
+
+   // Check that all masks cover the same atoms
+   const int num_atoms = statistics[0]->get_mask().size();
+   for(int s=1; s<num_statistics; ++s){
+      if(int(statistics[s]->get_mask().size()) != num_atoms){
+         terminaltextcolor(RED);
+         std::cerr << "Programmer Error - masks for combined magnetization statistics have different numbers of atoms." << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Programmer Error - masks for combined magnetization statistics have different numbers of atoms." << std::endl;
+         err::vexit();
+      }
+   }
+
+   // Determine offsets of each statistic in combined magnetization array
+   std::vector<int> offset(num_statistics+1,0);
+   for(int s=0; s<num_statistics; ++s) offset[s+1] = offset[s] + 4*statistics[s]->get_mask_size();
+
+   // initialise combined magnetization to zero
+   static std::vector<double> magnetization;
+   magnetization.assign(offset[num_statistics],0.0);
+
+   // calculate contributions of spins to each magetization category of all masks
    for(int atom=0; atom<num_atoms; ++atom){
-      const int mask_id = mask[atom]; // get mask id
-      magnetization[4*mask_id + 0] += sx[atom]*mm[atom];
-      magnetization[4*mask_id + 1] += sy[atom]*mm[atom];
-      magnetization[4*mask_id + 2] += sz[atom]*mm[atom];
-      magnetization[4*mask_id + 3] += mm[atom];
+      const double mx = sx[atom]*mm[atom];
+      const double my = sy[atom]*mm[atom];
+      const double mz = sz[atom]*mm[atom];
+      for(int s=0; s<num_statistics; ++s){
+         const int idx = offset[s] + 4*statistics[s]->get_mask()[atom]; // get mask id
+         magnetization[idx + 0] += mx;
+         magnetization[idx + 1] += my;
+         magnetization[idx + 2] += mz;
+         magnetization[idx + 3] += mm[atom];
+      }
    }
 
+   stats::reduce_magnetization(statistics, magnetization);
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to reduce combined magnetization of several masks on all CPUs and normalize
+//------------------------------------------------------------------------------------------------------
+void reduce_magnetization(std::vector<magnetization_statistic_t*>& statistics, std::vector<double>& magnetization){
+
    // Reduce on all CPUS
    #ifdef MPICF
-      MPI_Allreduce(MPI_IN_PLACE, &magnetization[0], 4*mask_size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce(MPI_IN_PLACE, &magnetization[0], magnetization.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
    #endif
 
+   // Copy magnetization to each statistic and normalize
+   int offset = 0;
+   for(unsigned int s=0; s<statistics.size(); ++s){
+      statistics[s]->set_magnetization(magnetization, offset);
+      offset += 4*statistics[s]->get_mask_size();
+   }
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to set magnetization from reduced totals starting at offset, normalize and add to mean
+//------------------------------------------------------------------------------------------------------
+void magnetization_statistic_t::set_magnetization(const std::vector<double>& totals, const int offset){
+
+   std::copy(totals.begin()+offset, totals.begin()+offset+4*mask_size, magnetization.begin());
+
    // Calculate magnetisation length and normalize
    for(int mask_id=0; mask_id<mask_size; ++mask_id){
       double msat = magnetization[4*mask_id + 3];
@@ -150,6 +221,21 @@ void magnetization_statistic_t::calculate_magnetization(const std::vector<double
 
 }
 
+//------------------------------------------------------------------------------------------------------
+// Functions to get mask data
+//------------------------------------------------------------------------------------------------------
+const std::vector<int>& magnetization_statistic_t::get_mask(){
+
+   return mask;
+
+}
+
+int magnetization_statistic_t::get_mask_size(){
+
+   return mask_size;
+
+}
+
 //------------------------------------------------------------------------------------------------------
 // Function to get magnetisation data
 //------------------------------------------------------------------------------------------------------
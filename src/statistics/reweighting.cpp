@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+// Vampire headers
+#include "errors.hpp"
+#include "stats.hpp"
+#include "vmpi.hpp"
+#include "vio.hpp"
+
+namespace stats{
+
+//------------------------------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------------------------------
+reweighting_statistic_t::reweighting_statistic_t (): initialized(false), num_atoms(0), saturation(0.0){}
+
+//------------------------------------------------------------------------------------------------------
+// Function to initialize data structures
+//------------------------------------------------------------------------------------------------------
+void reweighting_statistic_t::initialize(const int in_num_atoms, const std::vector<double>& mm){
+
+   num_atoms = in_num_atoms;
+
+   // total moment of system in mu_B
+   saturation = 0.0;
+   for(int atom=0; atom<num_atoms; ++atom) saturation += mm[atom];
+
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &saturation, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   temperatures.resize(0);
+   energy.resize(0);
+   magnetization.resize(0);
+
+   initialized = true;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to start a new series of samples at a given temperature
+//------------------------------------------------------------------------------------------------------
+void reweighting_statistic_t::set_temperature(const double temperature){
+
+   temperatures.push_back(temperature);
+   energy.push_back(std::vector<double>(0));
+   magnetization.push_back(std::vector<double>(0));
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to record total energy (J) and reduced magnetization length of current state
+//------------------------------------------------------------------------------------------------------
+void reweighting_statistic_t::calculate(const std::vector<double>& sx, // spin unit vector
+                                        const std::vector<double>& sy,
+                                        const std::vector<double>& sz,
+                                        const std::vector<double>& mm,
+                                        const double total_energy){
+
+   if(temperatures.size()==0) return;
+
+   double m[3] = {0.0, 0.0, 0.0};
+   for(int atom=0; atom<num_atoms; ++atom){
+      m[0] += sx[atom]*mm[atom];
+      m[1] += sy[atom]*mm[atom];
+      m[2] += sz[atom]*mm[atom];
+   }
+
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &m[0], 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   energy.back().push_back(total_energy);
+   magnetization.back().push_back(sqrt(m[0]*m[0] + m[1]*m[1] + m[2]*m[2])/saturation);
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to solve multi-histogram equations and output reweighted averages
+//
+// The free energies f_k of all runs at inverse temperature b_k with n_k samples are found by
+// iterating (A M Ferrenberg and R H Swendsen, Phys. Rev. Lett. 63, 1195 (1989))
+//
+//       exp(-f_k) = sum_s exp(-b_k E_s) / sum_j n_j exp(f_j - b_j E_s)
+//
+// where s runs over all samples of all runs. Averages at any b are then weighted by
+//
+//       w_s(b) = exp(-b E_s) / sum_j n_j exp(f_j - b_j E_s)
+//
+// All exponentials are evaluated as log-sum-exp since b E_s is of order of the number of spins.
+//------------------------------------------------------------------------------------------------------
+void reweighting_statistic_t::output(std::string filename, const int num_points){
+
+   if(!initialized) return;
+
+   const double kB = 1.3806503e-23;
+
+   // Collect runs at finite temperature with data
+   std::vector<double> beta;
+   std::vector<double> num_samples;
+   std::vector<int> run;
+   for(unsigned int r=0; r<temperatures.size(); r++){
+      if(temperatures[r] > 0.0 && energy[r].size() > 0){
+         beta.push_back(1.0/(kB*temperatures[r]));
+         num_samples.push_back(double(energy[r].size()));
+         run.push_back(r);
+      }
+   }
+   const int num_runs = run.size();
+
+   if(num_runs==0){
+      zlog << zTs() << "Warning - no finite temperature samples recorded for histogram reweighting" << std::endl;
+      return;
+   }
+
+   // Initial estimate of free energies from thermodynamic integration, df/db = <E>
+   std::vector<double> mean_energy(num_runs,0.0);
+   for(int r=0; r<num_runs; r++){
+      const std::vector<double>& E = energy[run[r]];
+      for(unsigned int s=0; s<E.size(); s++) mean_energy[r] += E[s];
+      mean_energy[r] /= num_samples[r];
+   }
+   std::vector<double> f(num_runs,0.0);
+   std::vector<double> f_new(num_runs,0.0);
+   for(int r=1; r<num_runs; r++) f[r] = f[r-1] + 0.5*(beta[r]-beta[r-1])*(mean_energy[r]+mean_energy[r-1]);
+
+   // log of denominator for each sample: log sum_j n_j exp(f_j - b_j E_s)
+   std::vector<std::vector<double> > log_denominator(num_runs);
+   for(int r=0; r<num_runs; r++) log_denominator[r].resize(energy[run[r]].size());
+
+   // Self-consistent solution of free energies
+   int iteration=0;
+   const int max_iterations=10000;
+   for(iteration=0; iteration<max_iterations; iteration++){
+
+      for(int r=0; r<num_runs; r++){
+         const std::vector<double>& E = energy[run[r]];
+         for(unsigned int s=0; s<E.size(); s++){
+            double max_term = -1.0e300;
+            for(int j=0; j<num_runs; j++) max_term = std::max(max_term, f[j]-beta[j]*E[s]);
+            double sum = 0.0;
+            for(int j=0; j<num_runs; j++) sum += num_samples[j]*exp(f[j]-beta[j]*E[s]-max_term);
+            log_denominator[r][s] = max_term + log(sum);
+         }
+      }
+
+      double max_change = 0.0;
+      for(int k=0; k<num_runs; k++){
+         double max_term = -1.0e300;
+         for(int r=0; r<num_runs; r++){
+            const std::vector<double>& E = energy[run[r]];
+            for(unsigned int s=0; s<E.size(); s++) max_term = std::max(max_term, -beta[k]*E[s]-log_denominator[r][s]);
+         }
+         double sum = 0.0;
+         for(int r=0; r<num_runs; r++){
+            const std::vector<double>& E = energy[run[r]];
+            for(unsigned int s=0; s<E.size(); s++) sum += exp(-beta[k]*E[s]-log_denominator[r][s]-max_term);
+         }
+         f_new[k] = -(max_term + log(sum));
+      }
+
+      // fix arbitrary constant with f_0 = 0
+      for(int k=num_runs-1; k>=0; k--){
+         f_new[k] -= f_new[0];
+         max_change = std::max(max_change, fabs(f_new[k]-f[k]));
+         f[k] = f_new[k];
+      }
+
+      // relative weights converged well below statistical error
+      if(max_change < 1.0e-4) break;
+
+   }
+
+   if(iteration==max_iterations) zlog << zTs() << "Warning - histogram reweighting of " << num_runs << " temperatures not converged after " << iteration << " iterations" << std::endl;
+   else zlog << zTs() << "Histogram reweighting of " << num_runs << " temperatures converged after " << iteration << " iterations" << std::endl;
+
+   // Only root process writes output
+   if(vmpi::my_rank!=0) return;
+
+   std::ofstream ofile(filename.c_str());
+   ofile << "# Temperature (K)\t<E> (J)\t<|m|>\tchi (mu_B/T)\tBinder cumulant U4" << std::endl;
+
+   const double Tmin = 1.0/(kB*beta[0]);
+   const double Tmax = 1.0/(kB*beta[num_runs-1]);
+   const int np = num_points > 1 ? num_points : 2;
+
+   for(int p=0; p<np; p++){
+
+      const double T = Tmin + (Tmax-Tmin)*double(p)/double(np-1);
+      const double b = 1.0/(kB*T);
+
+      // find maximum log weight for numerical stability
+      double max_term = -1.0e300;
+      for(int r=0; r<num_runs; r++){
+         const std::vector<double>& E = energy[run[r]];
+         for(unsigned int s=0; s<E.size(); s++) max_term = std::max(max_term, -b*E[s]-log_denominator[r][s]);
+      }
+
+      double sum_w=0.0, sum_E=0.0, sum_m=0.0, sum_m2=0.0, sum_m4=0.0;
+      for(int r=0; r<num_runs; r++){
+         const std::vector<double>& E = energy[run[r]];
+         const std::vector<double>& m = magnetization[run[r]];
+         for(unsigned int s=0; s<E.size(); s++){
+            const double w = exp(-b*E[s]-log_denominator[r][s]-max_term);
+            const double m2 = m[s]*m[s];
+            sum_w  += w;
+            sum_E  += w*E[s];
+            sum_m  += w*m[s];
+            sum_m2 += w*m2;
+            sum_m4 += w*m2*m2;
+         }
+      }
+
+      const double mean_E  = sum_E/sum_w;
+      const double mean_m  = sum_m/sum_w;
+      const double mean_m2 = sum_m2/sum_w;
+      const double mean_m4 = sum_m4/sum_w;
+
+      // chi = sum_i mu_i / k_B T ( <m^2> - <m>^2 ), as for susceptibility statistic
+      const double chi = 9.274e-24/(kB*T)*saturation*(mean_m2 - mean_m*mean_m);
+      const double binder = 1.0 - mean_m4/(3.0*mean_m2*mean_m2);
+
+      ofile << T << "\t" << mean_E << "\t" << mean_m << "\t" << chi << "\t" << binder << std::endl;
+
+   }
+
+   ofile.close();
+
+   return;
+
+}
+
+} // end of namespace stats
@@ -19,6 +19,21 @@
 
 namespace stats{
 
+   //------------------------------------------------------------------------------------------------------
+   // Function to list magnetization statistics classes enabled for calculation
+   //------------------------------------------------------------------------------------------------------
+   void enabled_magnetization_statistics(std::vector<magnetization_statistic_t*>& statistics){
+
+      statistics.resize(0);
+      if(stats::calculate_system_magnetization)          statistics.push_back(&stats::system_magnetization);
+      if(stats::calculate_material_magnetization)        statistics.push_back(&stats::material_magnetization);
+      if(stats::calculate_height_magnetization)          statistics.push_back(&stats::height_magnetization);
+      if(stats::calculate_material_height_magnetization) statistics.push_back(&stats::material_height_magnetization);
+
+      return;
+
+   }
+
    //------------------------------------------------------------------------------------------------------
    // Function to update required statistics classes
    //------------------------------------------------------------------------------------------------------
@@ -27,11 +42,76 @@ namespace stats{
                const std::vector<double>& sz,
                const std::vector<double>& mm){
 
-      // update magnetization statistics
-      if(stats::calculate_system_magnetization)          stats::system_magnetization.calculate_magnetization(sx,sy,sz,mm);
-      if(stats::calculate_material_magnetization)        stats::material_magnetization.calculate_magnetization(sx,sy,sz,mm);
-      if(stats::calculate_height_magnetization)          stats::height_magnetization.calculate_magnetization(sx,sy,sz,mm);
-      if(stats::calculate_material_height_magnetization) stats::material_height_magnetization.calculate_magnetization(sx,sy,sz,mm);
+      // update magnetization statistics in a single pass
+      std::vector<magnetization_statistic_t*> statistics;
+      enabled_magnetization_statistics(statistics);
+      stats::calculate_magnetization(statistics,sx,sy,sz,mm);
+
+      // update susceptibility statistics
+      if(stats::calculate_system_susceptibility)         stats::system_susceptibility.calculate(stats::system_magnetization.get_magnetization());
+
+      return;
+
+   }
+
+   //------------------------------------------------------------------------------------------------------
+   // Function to prepare accumulation of magnetization statistics during an integrator sweep
+   //------------------------------------------------------------------------------------------------------
+   void begin_sweep(const std::vector<double>& mm){
+
+      stats::sweep_valid = false;
+
+      std::vector<magnetization_statistic_t*> statistics;
+      enabled_magnetization_statistics(statistics);
+
+      // masks of all statistics cover the same atoms
+      if(statistics.size()==0 || statistics[0]->get_mask().size()==0) return;
+
+      stats::sweep_num_statistics = statistics.size();
+      stats::sweep_offset.resize(statistics.size());
+      stats::sweep_mask.resize(statistics.size());
+
+      int offset = 0;
+      for(unsigned int s=0; s<statistics.size(); ++s){
+         stats::sweep_offset[s] = offset;
+         stats::sweep_mask[s] = &statistics[s]->get_mask()[0];
+         offset += 4*statistics[s]->get_mask_size();
+      }
+
+      stats::sweep_magnetization.assign(offset,0.0);
+      stats::sweep_moment = &mm[0];
+      stats::sweep_active = true;
+
+      return;
+
+   }
+
+   //------------------------------------------------------------------------------------------------------
+   // Function to mark accumulated magnetization statistics as valid for given time
+   //------------------------------------------------------------------------------------------------------
+   void end_sweep(const uint64_t time){
+
+      if(stats::sweep_active){
+         stats::sweep_valid = true;
+         stats::sweep_time = time;
+      }
+      stats::sweep_active = false;
+
+      return;
+
+   }
+
+   //------------------------------------------------------------------------------------------------------
+   // Function to update required statistics classes from magnetization accumulated by integrator
+   //------------------------------------------------------------------------------------------------------
+   void update_from_sweep(){
+
+      std::vector<magnetization_statistic_t*> statistics;
+      enabled_magnetization_statistics(statistics);
+      stats::reduce_magnetization(statistics, stats::sweep_magnetization);
+
+      // accumulated values are used only once
+      stats::sweep_valid = false;
 
       // update susceptibility statistics
       if(stats::calculate_system_susceptibility)         stats::system_susceptibility.calculate(stats::system_magnetization.get_magnetization());
@@ -54,6 +134,9 @@ namespace stats{
       // reset susceptibility statistics
       if(stats::calculate_system_susceptibility) stats::system_susceptibility.reset_averages();
 
+      // reset structure factor statistics
+      if(stats::calculate_structure_factor) stats::structure_factor.reset_averages();
+
       return;
 
    }
@@ -0,0 +1,469 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+// (c) R F L Evans 2014. All rights reserved.
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// Vampire headers
+#include "errors.hpp"
+#include "stats.hpp"
+#include "vio.hpp"
+#include "vmath.hpp"
+#include "vmpi.hpp"
+
+namespace stats{
+
+//------------------------------------------------------------------------------------------------------
+// Function to wrap grid index on periodic FFT grid to range [-np/2, np/2)
+//------------------------------------------------------------------------------------------------------
+inline int wrap_index(const int i, const int np){
+   return 2*i < np ? i : i-np;
+}
+
+//------------------------------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------------------------------
+structure_factor_statistic_t::structure_factor_statistic_t (): initialized(false), num_atoms(0), direction(0), num_sublattices(1),
+                                                               num_zones(1), mean_counter(0.0){}
+
+//------------------------------------------------------------------------------------------------------
+// Function to initialize data structures
+//
+//    Spins of each sublattice are summed on a grid of unit cells with integer coordinates cx, cy, cz
+//    and size cell_size (Angstroms). The grid is zero padded to a power of two at least 2n-1 in each
+//    dimension so that the correlation function obtained from the inverse transform does not wrap
+//    around. Sublattice transforms are combined with the phase exp(-i q.u) of their position u in
+//    the unit cell, and for unit cells with more than one atom wavevectors beyond the first
+//    reciprocal unit cell are sampled, so that there are at least as many q points as atoms.
+//
+//------------------------------------------------------------------------------------------------------
+void structure_factor_statistic_t::initialize(const int in_num_atoms,
+                                              const std::vector<int>& cx,
+                                              const std::vector<int>& cy,
+                                              const std::vector<int>& cz,
+                                              const std::vector<int>& sublattice_array,
+                                              const int in_num_sublattices,
+                                              const std::vector<double>& x, // atomic coordinates (A)
+                                              const std::vector<double>& y,
+                                              const std::vector<double>& z,
+                                              const double cell_size[3],
+                                              const int in_direction){
+
+   num_atoms = in_num_atoms;
+   num_sublattices = in_num_sublattices;
+   direction = in_direction;
+
+   // Determine extent of unit cell grid on all CPUs
+   int cell_max[3] = {-1000000000,-1000000000,-1000000000};
+   for(int i=0; i<3; ++i) cell_min[i] = 1000000000;
+   for(int atom=0; atom<num_atoms; ++atom){
+      const int c[3] = {cx[atom], cy[atom], cz[atom]};
+      for(int i=0; i<3; ++i){
+         if(c[i]<cell_min[i]) cell_min[i]=c[i];
+         if(c[i]>cell_max[i]) cell_max[i]=c[i];
+      }
+   }
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &cell_min[0], 3, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+      MPI_Allreduce(MPI_IN_PLACE, &cell_max[0], 3, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   #endif
+
+   // Determine position of each sublattice within unit cell
+   offset.assign(3*num_sublattices,-1.0e300);
+   for(int atom=0; atom<num_atoms; ++atom){
+      const int s = sublattice_array[atom];
+      offset[3*s+0] = x[atom]-double(cx[atom])*cell_size[0];
+      offset[3*s+1] = y[atom]-double(cy[atom])*cell_size[1];
+      offset[3*s+2] = z[atom]-double(cz[atom])*cell_size[2];
+   }
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &offset[0], 3*num_sublattices, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   #endif
+
+   // Number of reciprocal unit cells sampled in each direction
+   num_zones = 1;
+   while(num_zones*num_zones*num_zones < num_sublattices) num_zones++;
+
+   for(int i=0; i<3; ++i){
+      n[i] = cell_max[i]-cell_min[i]+1;
+      np[i] = vmath::next_power_of_two(2*n[i]-1);
+      a[i] = cell_size[i];
+   }
+
+   // Check selected direction is not a single unit cell thick
+   if(direction>0 && n[direction-1]<2){
+      terminaltextcolor(RED);
+      std::cerr << "Error - structure factor direction must have more than one unit cell - please select another direction." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - structure factor direction must have more than one unit cell - please select another direction." << std::endl;
+      err::vexit();
+   }
+
+   const int num_cells = n[0]*n[1]*n[2];
+   const int num_padded_cells = np[0]*np[1]*np[2];
+
+   // Reciprocal and real space bin widths from finest grid spacing
+   dq = 0.0;
+   dr = 0.0;
+   double qmax2 = 0.0;
+   double rmax2 = 0.0;
+   double rmax[3];
+   for(int i=0; i<3; ++i){
+      double span = 0.0;
+      for(int s=0; s<num_sublattices; ++s){
+         for(int t=0; t<num_sublattices; ++t) span = std::max(span, offset[3*s+i]-offset[3*t+i]);
+      }
+      rmax[i] = double(n[i]-1)*a[i] + span;
+      rmax2 += rmax[i]*rmax[i];
+      if(num_zones*np[i]>1) qmax2 += (double(num_zones)*M_PI/a[i])*(double(num_zones)*M_PI/a[i]);
+      if(n[i]<2) continue;
+      const double qi = 2.0*M_PI/(double(np[i])*a[i]);
+      if(dq==0.0 || qi<dq) dq=qi;
+      if(dr==0.0 || a[i]<dr) dr=a[i];
+   }
+   if(dq==0.0) dq=1.0;
+   if(dr==0.0) dr=1.0;
+   dr /= double(num_zones);
+
+   // neighbour shells of multi-atom unit cells are not multiples of the sublattice spacing
+   if(num_sublattices>1) dr *= 0.25;
+
+   // Number of bins
+   int num_q_bins, num_r_bins;
+   if(direction==0){
+      num_q_bins = int(sqrt(qmax2)/dq+0.5)+1;
+      num_r_bins = int(sqrt(rmax2)/dr+0.5)+1;
+   }
+   else{
+      num_q_bins = num_zones*np[direction-1]/2+1;
+      num_r_bins = int(rmax[direction-1]*double(num_zones)/a[direction-1]+0.5)+1;
+   }
+
+   // Store grid cell of each local atom
+   cell_array.resize(num_atoms);
+   std::vector<double> occupancy(num_sublattices*num_cells,0.0);
+   for(int atom=0; atom<num_atoms; ++atom){
+      const int cell = ((cx[atom]-cell_min[0])*n[1] + cy[atom]-cell_min[1])*n[2] + cz[atom]-cell_min[2];
+      occupancy[sublattice_array[atom]*num_cells+cell] += 1.0;
+      cell_array[atom] = 3*sublattice_array[atom]*num_cells + cell;
+   }
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &occupancy[0], num_sublattices*num_cells, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   grid.assign(3*num_sublattices*num_cells,0.0);
+
+   q_sum.assign(num_q_bins,0.0);
+   q_modes.assign(num_q_bins,0.0);
+   r_sum.assign(num_r_bins,0.0);
+   r_pairs.assign(num_r_bins,0.0);
+
+   // transforms are only calculated on root process
+   if(vmpi::my_rank==0){
+
+      work.assign(num_padded_cells,0.0);
+      transform.assign(3*num_sublattices,work);
+
+      num_atoms_total = 0.0;
+      for(unsigned int id=0; id<occupancy.size(); ++id) num_atoms_total += occupancy[id];
+
+      // Sublattice phase factors exp(-i q.u) along each direction
+      for(int c=0; c<3; ++c){
+         const int nz = num_zones*np[c];
+         phase[c].resize(num_sublattices*nz);
+         for(int s=0; s<num_sublattices; ++s){
+            for(int m=0; m<nz; ++m){
+               const double q = 2.0*M_PI*double(wrap_index(m,nz))/(double(np[c])*a[c]);
+               phase[c][s*nz+m] = std::polar(1.0, -q*offset[3*s+c]);
+            }
+         }
+      }
+
+      // Count wavevectors in each bin
+      for(int i=0; i<num_zones*np[0]; ++i){
+         for(int j=0; j<num_zones*np[1]; ++j){
+            for(int k=0; k<num_zones*np[2]; ++k){
+               const int bin = q_bin(i,j,k);
+               if(bin>=0) q_modes[bin] += 1.0;
+            }
+         }
+      }
+
+      // Count atom pairs at each displacement from autocorrelation of sublattice occupancies
+      for(int s=0; s<num_sublattices; ++s){
+         fill_work(occupancy, s*num_cells);
+         vmath::fft3d(work, np, false);
+         transform[3*s] = work;
+      }
+      correlate(r_pairs, 1);
+
+      // Print memory requirements to log
+      const double memory = (16.0*double((3*num_sublattices+1)*num_padded_cells) + 8.0*double(3*num_sublattices*num_cells+num_atoms))/1.0e6;
+      zlog << zTs() << "Structure factor calculation enabled for " << num_sublattices << " sublattices on a padded grid of "
+           << np[0] << " x " << np[1] << " x " << np[2] << " unit cells and requires " << memory << " MB of RAM" << std::endl;
+
+   }
+
+   mean_counter = 0.0;
+   initialized = true;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to determine reciprocal space bin of extended grid point, or -1 if not sampled
+//------------------------------------------------------------------------------------------------------
+int structure_factor_statistic_t::q_bin(const int i, const int j, const int k){
+
+   const int w[3] = {wrap_index(i,num_zones*np[0]), wrap_index(j,num_zones*np[1]), wrap_index(k,num_zones*np[2])};
+
+   if(direction>0){
+      const int d = direction-1;
+      for(int c=0; c<3; ++c) if(c!=d && w[c]!=0) return -1;
+      return abs(w[d]);
+   }
+
+   double q2 = 0.0;
+   for(int c=0; c<3; ++c){
+      const double qc = 2.0*M_PI*double(w[c])/(double(np[c])*a[c]);
+      q2 += qc*qc;
+   }
+
+   const int bin = int(sqrt(q2)/dq+0.5);
+
+   return bin < int(q_sum.size()) ? bin : -1;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to determine real space bin of displacement between sublattices sa and sb separated by
+// padded grid point, or -1 if not sampled
+//------------------------------------------------------------------------------------------------------
+int structure_factor_statistic_t::r_bin(const int i, const int j, const int k, const int sa, const int sb){
+
+   const int w[3] = {wrap_index(i,np[0]), wrap_index(j,np[1]), wrap_index(k,np[2])};
+
+   // displacements beyond system size have no pairs
+   for(int c=0; c<3; ++c) if(abs(w[c])>=n[c]) return -1;
+
+   double r[3];
+   for(int c=0; c<3; ++c) r[c] = double(w[c])*a[c] + offset[3*sb+c] - offset[3*sa+c];
+
+   int bin;
+   if(direction>0){
+      const int d = direction-1;
+      for(int c=0; c<3; ++c) if(c!=d && fabs(r[c])>1.0e-6) return -1;
+      bin = int(fabs(r[d])*double(num_zones)/a[d]+0.5);
+   }
+   else bin = int(sqrt(r[0]*r[0]+r[1]*r[1]+r[2]*r[2])/dr+0.5);
+
+   return bin < int(r_sum.size()) ? bin : -1;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to copy component of unit cell grid to zero padded work array
+//------------------------------------------------------------------------------------------------------
+void structure_factor_statistic_t::fill_work(const std::vector<double>& cells, const int start){
+
+   for(unsigned int id=0; id<work.size(); ++id) work[id] = 0.0;
+
+   for(int i=0; i<n[0]; ++i){
+      for(int j=0; j<n[1]; ++j){
+         for(int k=0; k<n[2]; ++k){
+            work[(i*np[1]+j)*np[2]+k] = cells[start+(i*n[1]+j)*n[2]+k];
+         }
+      }
+   }
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to accumulate correlations between all sublattice pairs in bins
+//
+//    The inverse transform of conj(F_a) F_b summed over components gives sum_R' S_a(R').S_b(R'+R)
+//    at displacement R + u_b - u_a. Pairs b > a also account for the equivalent pair (b,a).
+//
+//------------------------------------------------------------------------------------------------------
+void structure_factor_statistic_t::correlate(std::vector<double>& sum, const int num_components){
+
+   const int num_padded_cells = np[0]*np[1]*np[2];
+
+   for(int sa=0; sa<num_sublattices; ++sa){
+      for(int sb=sa; sb<num_sublattices; ++sb){
+
+         for(int id=0; id<num_padded_cells; ++id){
+            work[id] = 0.0;
+            for(int c=0; c<num_components; ++c) work[id] += std::conj(transform[3*sa+c][id])*transform[3*sb+c][id];
+         }
+         vmath::fft3d(work, np, true);
+
+         const double weight = (sa==sb ? 1.0 : 2.0)/double(num_padded_cells);
+         for(int i=0; i<np[0]; ++i){
+            for(int j=0; j<np[1]; ++j){
+               for(int k=0; k<np[2]; ++k){
+                  const int bin = r_bin(i,j,k,sa,sb);
+                  if(bin>=0) sum[bin] += work[(i*np[1]+j)*np[2]+k].real()*weight;
+               }
+            }
+         }
+
+      }
+   }
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate structure factor and correlation function of current spin configuration
+//
+//       S(q) = 1/N | sum_i S_i exp(-i q.r_i) |^2  =  1/N | sum_s exp(-i q.u_s) F_s(q) |^2
+//
+//       C(r) = sum_ij S_i.S_j / sum_ij 1,  for r_j - r_i = r
+//
+//    where F_s is the transform of sublattice s on the unit cell grid. C(r) is the inverse transform
+//    of the sublattice cross spectra (Wiener-Khinchin) normalised by the number of pairs.
+//
+//------------------------------------------------------------------------------------------------------
+void structure_factor_statistic_t::calculate(const std::vector<double>& sx, // spin unit vector
+                                             const std::vector<double>& sy,
+                                             const std::vector<double>& sz){
+
+   if(!initialized) return;
+
+   const int num_cells = n[0]*n[1]*n[2];
+
+   // Sum spins in each unit cell for each sublattice
+   for(unsigned int id=0; id<grid.size(); ++id) grid[id] = 0.0;
+   for(int atom=0; atom<num_atoms; ++atom){
+      const int cell = cell_array[atom];
+      grid[cell]               += sx[atom];
+      grid[num_cells+cell]     += sy[atom];
+      grid[2*num_cells+cell]   += sz[atom];
+   }
+
+   // Reduce grid on root process, which alone calculates transforms
+   #ifdef MPICF
+      if(vmpi::my_rank==0) MPI_Reduce(MPI_IN_PLACE, &grid[0], grid.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+      else{
+         MPI_Reduce(&grid[0], &grid[0], grid.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+         return;
+      }
+   #endif
+
+   // Transform each component of each sublattice
+   for(int id=0; id<3*num_sublattices; ++id){
+      fill_work(grid, id*num_cells);
+      vmath::fft3d(work, np, false);
+      transform[id] = work;
+   }
+
+   // Accumulate structure factor in bins over extended grid of wavevectors
+   const double inorm = 1.0/num_atoms_total;
+   const int nz[3] = {num_zones*np[0], num_zones*np[1], num_zones*np[2]};
+   std::vector<std::complex<double> > sublattice_phase(num_sublattices);
+   for(int i=0; i<nz[0]; ++i){
+      for(int j=0; j<nz[1]; ++j){
+         for(int k=0; k<nz[2]; ++k){
+
+            const int bin = q_bin(i,j,k);
+            if(bin<0) continue;
+
+            for(int s=0; s<num_sublattices; ++s){
+               sublattice_phase[s] = phase[0][s*nz[0]+i]*phase[1][s*nz[1]+j]*phase[2][s*nz[2]+k];
+            }
+
+            const int id = ((i%np[0])*np[1]+j%np[1])*np[2]+k%np[2];
+            double power = 0.0;
+            for(int c=0; c<3; ++c){
+               std::complex<double> amplitude(0.0,0.0);
+               for(int s=0; s<num_sublattices; ++s) amplitude += sublattice_phase[s]*transform[3*s+c][id];
+               power += std::norm(amplitude);
+            }
+            q_sum[bin] += power*inorm;
+
+         }
+      }
+   }
+
+   // Inverse transform to correlation function and accumulate in bins
+   correlate(r_sum, 3);
+
+   mean_counter+=1.0;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to reset statistical averages
+//------------------------------------------------------------------------------------------------------
+void structure_factor_statistic_t::reset_averages(){
+
+   std::fill(q_sum.begin(),q_sum.end(),0.0);
+   std::fill(r_sum.begin(),r_sum.end(),0.0);
+
+   mean_counter = 0.0;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to append mean structure factor and correlation function to output files (root only)
+//
+//    structure-factor.txt      header of bin wavevectors (1/A), then time, temperature, S(q) ...
+//    correlation-function.txt  header of bin distances (A), then time, temperature, C(r) ...
+//
+//------------------------------------------------------------------------------------------------------
+void structure_factor_statistic_t::output(const double time, const double temperature){
+
+   if(vmpi::my_rank!=0 || !initialized) return;
+
+   // open files and write bin centres on first call
+   if(!sq_file.is_open()){
+      const double q_width = direction>0 ? 2.0*M_PI/(double(np[direction-1])*a[direction-1]) : dq;
+      sq_file.open("structure-factor.txt");
+      sq_file << "# q (1/A):";
+      for(unsigned int bin=0; bin<q_sum.size(); ++bin) sq_file << "\t" << double(bin)*q_width;
+      sq_file << std::endl;
+
+      const double r_width = direction>0 ? a[direction-1]/double(num_zones) : dr;
+      cr_file.open("correlation-function.txt");
+      cr_file << "# r (A):";
+      for(unsigned int bin=0; bin<r_sum.size(); ++bin) cr_file << "\t" << double(bin)*r_width;
+      cr_file << std::endl;
+   }
+
+   const double imean_counter = mean_counter > 0.0 ? 1.0/mean_counter : 0.0;
+
+   sq_file << time << "\t" << temperature;
+   for(unsigned int bin=0; bin<q_sum.size(); ++bin){
+      sq_file << "\t" << (q_modes[bin] > 0.0 ? q_sum[bin]*imean_counter/q_modes[bin] : 0.0);
+   }
+   sq_file << std::endl;
+
+   cr_file << time << "\t" << temperature;
+   for(unsigned int bin=0; bin<r_sum.size(); ++bin){
+      cr_file << "\t" << (r_pairs[bin] > 0.5 ? r_sum[bin]*imean_counter/r_pairs[bin] : 0.0);
+   }
+   cr_file << std::endl;
+
+   return;
+
+}
+
+} // end of namespace stats
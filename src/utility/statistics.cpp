@@ -115,6 +115,7 @@ namespace stats
 	void system_energy();
 	
 	bool is_initialised=false;
+	bool convergence_projection=false; /// monitor magnetisation along applied field
 
 	double data_counter=0.0;		/// number of data points for averaging
 	
@@ -181,7 +182,9 @@ int mag_m(){
    }
 
    // update statistics - need to eventually replace mag_m() with stats::update()...
-   stats::update(atoms::x_spin_array, atoms::y_spin_array, atoms::z_spin_array, atoms::m_spin_array);
+   // using magnetisation accumulated by integrator for current spins if available
+   if(stats::sweep_valid==true && stats::sweep_time==sim::time) stats::update_from_sweep();
+   else stats::update(atoms::x_spin_array, atoms::y_spin_array, atoms::z_spin_array, atoms::m_spin_array);
 
    // optionally calculate system torque
    if(stats::calculate_torque==true) stats::system_torque();
@@ -250,6 +253,135 @@ void mag_m_reset(){
 
 }
 
+/// @brief Starts a new convergence-driven sampling window.
+///
+/// @details Monitors the reduced magnetisation length, the reduced magnetisation
+///          along a non-zero applied field and, if energies are calculated, the
+///          total energy relative to its mean. In zero field the direction of
+///          the magnetisation diffuses and is not monitored.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author		Richard Evans, richard.evans@york.ac.uk
+/// @version	1.0
+/// @date		14/05/2012
+///
+/// @internal
+///	Created:		14/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void convergence_reset(){
+
+	if(stats::calculate_convergence==false) return;
+
+	stats::convergence_projection = (sim::H_applied!=0.0);
+
+	int num_values=1;
+	if(stats::convergence_projection==true) num_values++;
+	if(stats::calculate_energy==true) num_values++;
+
+	stats::convergence.initialize(num_values);
+	if(stats::calculate_energy==true) stats::convergence.set_relative_error(num_values-1);
+
+}
+
+/// @brief Adds current system statistics to convergence estimates.
+///
+/// @details Must be called after mag_m() so that the magnetisation and energy
+///          are up to date.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author		Richard Evans, richard.evans@york.ac.uk
+/// @version	1.0
+/// @date		14/05/2012
+///
+/// @internal
+///	Created:		14/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void convergence_update(){
+
+	if(stats::calculate_convergence==false) return;
+
+	const std::vector<double>& m = stats::system_magnetization.get_magnetization();
+
+	std::vector<double> values(1,m[3]);
+	if(stats::convergence_projection==true) values.push_back((m[0]*sim::H_vec[0]+m[1]*sim::H_vec[1]+m[2]*sim::H_vec[2])*m[3]);
+	if(stats::calculate_energy==true){
+		double energy=stats::total_energy;
+		// energy is only reduced on root, so share to give identical decisions on all CPUs
+		#ifdef MPICF
+			MPI::COMM_WORLD.Bcast(&energy,1,MPI_DOUBLE,0);
+		#endif
+		values.push_back(energy);
+	}
+
+	stats::convergence.add(values);
+
+}
+
+/// @brief Determines if the current sampling window has converged.
+///
+/// @return true if standard errors of all monitored statistics are below target
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author		Richard Evans, richard.evans@york.ac.uk
+/// @version	1.0
+/// @date		14/05/2012
+///
+/// @internal
+///	Created:		14/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+bool convergence_reached(){
+
+	if(stats::calculate_convergence==false) return false;
+
+	return stats::convergence.is_converged(stats::convergence_target_error, stats::convergence_minimum_samples);
+
+}
+
+/// @brief Writes achieved errors of the current sampling window to the log file.
+///
+/// @section License
+/// Use of this code, either in source or compiled form, is subject to license from the authors.
+/// Copyright \htmlonly &copy \endhtmlonly Richard Evans, 2009-2012. All Rights Reserved.
+///
+/// @section Information
+/// @author		Richard Evans, richard.evans@york.ac.uk
+/// @version	1.0
+/// @date		14/05/2012
+///
+/// @internal
+///	Created:		14/05/2012
+///	Revision:	  ---
+///=====================================================================================
+///
+void convergence_log(){
+
+	if(stats::calculate_convergence==false) return;
+
+	zlog << zTs() << "Sampling window " << (stats::convergence_reached() ? "converged" : "reached maximum length");
+	zlog << " after " << stats::convergence.get_num_samples() << " samples, standard error ";
+	zlog << stats::convergence.output_standard_error() << "autocorrelation time ";
+	zlog << stats::convergence.output_autocorrelation_time() << std::endl;
+
+}
+
 double max_torque(){
   ///================================================================================================
   ///
@@ -444,6 +444,37 @@ void check_for_valid_int(  unsigned int& value, /// value of variable as in inpu
 
 }
 
+///
+/// Function to check that only one dipole field solver is selected
+///-----------------------------------------------------------------------
+///
+void check_for_unique_dipole_solver(std::string word, /// input file keyword
+                                    int line, /// input file line
+                                    std::string prefix, /// input file prefix
+                                    std::string solver) /// solver selected by keyword
+{
+   // keyword and solver of first selection
+   static std::string selected_word="";
+   static std::string selected_solver="";
+
+   if(selected_solver!="" && selected_solver!=solver){
+      terminaltextcolor(RED);
+      std::cerr << "Error: " << prefix << word << " on line " << line << " of input file conflicts with " << prefix << selected_word
+                << ", only one dipole field solver can be enabled." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error: " << prefix << word << " on line " << line << " of input file conflicts with " << prefix << selected_word
+           << ", only one dipole field solver can be enabled." << std::endl;
+      err::vexit();
+   }
+
+   if(selected_solver==""){
+      selected_word=word;
+      selected_solver=solver;
+   }
+
+   return;
+}
+
 ///-----------------------------------------------------------------------
 /// Function to check for valid boolean
 ///
@@ -1431,6 +1462,11 @@ int match_sim(string const word, string const value, string const unit, int cons
          sim::integrator=4;
          return EXIT_SUCCESS;
       }
+      test="wolff-monte-carlo";
+      if(value==test){
+         sim::integrator=5;
+         return EXIT_SUCCESS;
+      }
       else{
 		 terminaltextcolor(RED);
          std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
@@ -1438,11 +1474,19 @@ int match_sim(string const word, string const value, string const unit, int cons
          std::cerr << "\t\"llg-midpoint\"" << std::endl;
          std::cerr << "\t\"monte-carlo\"" << std::endl;
          std::cerr << "\t\"constrained-monte-carlo\"" << std::endl;
+         std::cerr << "\t\"hybrid-constrained-monte-carlo\"" << std::endl;
+         std::cerr << "\t\"wolff-monte-carlo\"" << std::endl;
 		 terminaltextcolor(WHITE);
          err::vexit();
       }
    }
    //-------------------------------------------------------------------
+   test="enable-integrator-statistics";
+   if(word==test){
+      sim::integrator_statistics=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
    test="program";
    if(word==test){
       test="benchmark";
@@ -1520,6 +1564,21 @@ int match_sim(string const word, string const value, string const unit, int cons
          sim::program=14;
          return EXIT_SUCCESS;
       }
+      test="parallel-tempering";
+      if(value==test){
+         sim::program=15;
+         return EXIT_SUCCESS;
+      }
+      test="wang-landau";
+      if(value==test){
+         sim::program=16;
+         return EXIT_SUCCESS;
+      }
+      test="dynamic-structure-factor";
+      if(value==test){
+         sim::program=17;
+         return EXIT_SUCCESS;
+      }
       test="diagnostic-boltzmann";
       if(value==test){
          sim::program=50;
@@ -1539,6 +1598,10 @@ int match_sim(string const word, string const value, string const unit, int cons
          std::cerr << "\t\"hybrid-cmc\"" << std::endl;
          std::cerr << "\t\"reverse-hybrid-cmc\"" << std::endl;
          std::cerr << "\t\"localised-temperature-pulse\"" << std::endl;
+         std::cerr << "\t\"effective-damping\"" << std::endl;
+         std::cerr << "\t\"parallel-tempering\"" << std::endl;
+         std::cerr << "\t\"wang-landau\"" << std::endl;
+         std::cerr << "\t\"dynamic-structure-factor\"" << std::endl;
          terminaltextcolor(WHITE);
 		 err::vexit();
       }
@@ -1558,7 +1621,79 @@ int match_sim(string const word, string const value, string const unit, int cons
    //-------------------------------------------------------------------
    test="enable-fast-dipole-fields";
    if(word==test){
+      check_for_unique_dipole_solver(word, line, prefix, "fast");
+      demag::fast=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-compressed-fast-dipole-fields";
+   if(word==test){
+      check_for_unique_dipole_solver(word, line, prefix, "fast");
       demag::fast=true;
+      demag::compressed=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-dipole-field-cache";
+   if(word==test){
+      demag::cache=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-cuboid-dipole-fields";
+   if(word==test){
+      demag::newell=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="dipole-field-cuboid-cutoff";
+   if(word==test){
+      double cutoff=atof(value.c_str());
+      check_for_valid_value(cutoff, word, line, prefix, unit, "none", 1.0, 20.0,"input","1.0 - 20.0");
+      demag::newell_cutoff=cutoff;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-periodic-dipole-fields";
+   if(word==test){
+      demag::periodic=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="dipole-field-periodic-images";
+   if(word==test){
+      int images=atoi(value.c_str());
+      check_for_valid_int(images, word, line, prefix, 1, 1000,"input","1 - 1000");
+      demag::periodic_images=images;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-fft-dipole-fields";
+   if(word==test){
+      check_for_unique_dipole_solver(word, line, prefix, "fft");
+      demag::fft=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-tree-dipole-fields";
+   if(word==test){
+      check_for_unique_dipole_solver(word, line, prefix, "tree");
+      demag::tree=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="dipole-field-tree-opening-angle";
+   if(word==test){
+      double theta=atof(value.c_str());
+      check_for_valid_value(theta, word, line, prefix, unit, "none", 0.0, 1.0,"input","0.0 - 1.0");
+      demag::tree_opening_angle=theta;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="enable-atomistic-dipole-fields";
+   if(word==test){
+      check_for_unique_dipole_solver(word, line, prefix, "atomistic");
+      demag::atomistic=true;
       return EXIT_SUCCESS;
    }
    //-------------------------------------------------------------------
@@ -1570,6 +1705,30 @@ int match_sim(string const word, string const value, string const unit, int cons
       return EXIT_SUCCESS;
    }
    //-------------------------------------------------------------------
+   test="dipole-field-update-tolerance";
+   if(word==test){
+      double tol=atof(value.c_str());
+      check_for_valid_value(tol, word, line, prefix, unit, "none", 0.0, 1.0,"input","0.0 - 1.0");
+      demag::update_tolerance=tol;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="dipole-field-maximum-update-interval";
+   if(word==test){
+      int mui=atoi(value.c_str());
+      check_for_valid_int(mui, word, line, prefix, 1, 1000000000,"input","1 - 1,000,000,000");
+      demag::maximum_update_interval=mui;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="dipole-field-partial-update-fraction";
+   if(word==test){
+      double puf=atof(value.c_str());
+      check_for_valid_value(puf, word, line, prefix, unit, "none", 0.0, 1.0,"input","0.0 - 1.0");
+      demag::partial_update_fraction=puf;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
    test="enable-surface-anisotropy";
    if(word==test){
       sim::surface_anisotropy=true;
@@ -1998,6 +2157,22 @@ int match_sim(string const word, string const value, string const unit, int cons
       return EXIT_SUCCESS;
    }
    //--------------------------------------------------------------------
+   test="constraint-angle-sweep-workers";
+   if(word==test){
+      int workers=atoi(value.c_str());
+      check_for_valid_int(workers, word, line, prefix, 1, 1000000,"input","1 - 1,000,000");
+      sim::constraint_sweep_workers=workers;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="constraint-angle-sweep-worker";
+   if(word==test){
+      int worker=atoi(value.c_str());
+      check_for_valid_int(worker, word, line, prefix, 0, 999999,"input","0 - 999,999");
+      sim::constraint_sweep_worker=worker;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
    test="constraint-angle-theta";
    if(word==test){
       double angle=atof(value.c_str());
@@ -2086,6 +2261,11 @@ int match_sim(string const word, string const value, string const unit, int cons
          sim::mc_algorithm=hinzke_nowak;
          return EXIT_SUCCESS;
       }
+      test="heat-bath";
+      if(value==test){
+         sim::mc_algorithm=heat_bath;
+         return EXIT_SUCCESS;
+      }
       else{
 		 terminaltextcolor(RED);
          std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
@@ -2093,11 +2273,165 @@ int match_sim(string const word, string const value, string const unit, int cons
          std::cerr << "\t\"uniform\"" << std::endl;
          std::cerr << "\t\"angle\"" << std::endl;
          std::cerr << "\t\"hinzke-nowak\"" << std::endl;
+         std::cerr << "\t\"heat-bath\"" << std::endl;
 		 terminaltextcolor(WHITE);
          err::vexit();
       }
    }
    //-------------------------------------------------------------------
+   test="monte-carlo-adaptive-step-width";
+   if(word==test){
+      sim::mc_adaptive_step_width=check_for_valid_bool(value, word, line, prefix,"input");
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="monte-carlo-target-acceptance";
+   if(word==test){
+      double acceptance=atof(value.c_str());
+      check_for_valid_value(acceptance, word, line, prefix, unit, "none", 0.01, 0.99,"input","0.01 - 0.99");
+      sim::mc_target_acceptance=acceptance;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="histogram-reweighting";
+   if(word==test){
+      stats::calculate_histogram_reweighting=check_for_valid_bool(value, word, line, prefix,"input");
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="histogram-reweighting-points";
+   if(word==test){
+      int points=atoi(value.c_str());
+      check_for_valid_int(points, word, line, prefix, 2, 100000,"input","2 - 100,000");
+      stats::histogram_reweighting_points=points;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="structure-factor";
+   if(word==test){
+      stats::calculate_structure_factor=check_for_valid_bool(value, word, line, prefix,"input");
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="structure-factor-rate";
+   if(word==test){
+      int rate=atoi(value.c_str());
+      check_for_valid_int(rate, word, line, prefix, 1, 1000000000,"input","1 - 1,000,000,000");
+      stats::structure_factor_rate=rate;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="structure-factor-direction";
+   if(word==test){
+      test="radial";
+      if(value==test){
+         stats::structure_factor_direction=0;
+         return EXIT_SUCCESS;
+      }
+      test="x";
+      if(value==test){
+         stats::structure_factor_direction=1;
+         return EXIT_SUCCESS;
+      }
+      test="y";
+      if(value==test){
+         stats::structure_factor_direction=2;
+         return EXIT_SUCCESS;
+      }
+      test="z";
+      if(value==test){
+         stats::structure_factor_direction=3;
+         return EXIT_SUCCESS;
+      }
+      else{
+         terminaltextcolor(RED);
+         std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
+         std::cerr << "\t\"radial\"" << std::endl;
+         std::cerr << "\t\"x\"" << std::endl;
+         std::cerr << "\t\"y\"" << std::endl;
+         std::cerr << "\t\"z\"" << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Error - value for \'sim:" << word << "\' must be one of radial, x, y or z" << std::endl;
+         err::vexit();
+      }
+   }
+   //-------------------------------------------------------------------
+   test="dynamic-structure-factor-file";
+   if(word==test){
+      std::string qfile=value;
+      // strip quotes
+      qfile.erase(remove(qfile.begin(), qfile.end(), '\"'), qfile.end());
+      test="";
+      if(qfile!=test){
+         stats::dynamic_structure_factor_file=qfile;
+         return EXIT_SUCCESS;
+      }
+      else{
+         terminaltextcolor(RED);
+         std::cerr << "Error - empty filename in control statement \'sim:" << word << "\' on line " << line << " of input file" << std::endl;
+         terminaltextcolor(WHITE);
+         return EXIT_FAILURE;
+      }
+   }
+   //-------------------------------------------------------------------
+   test="convergence-target-error";
+   if(word==test){
+      double error=atof(value.c_str());
+      check_for_valid_value(error, word, line, prefix, unit, "none", 1.0e-12, 1.0,"input","1e-12 - 1");
+      stats::convergence_target_error=error;
+      stats::calculate_convergence=true;
+      stats::calculate_system_magnetization=true;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="convergence-minimum-samples";
+   if(word==test){
+      int samples=atoi(value.c_str());
+      check_for_valid_int(samples, word, line, prefix, 32, 1000000000,"input","32 - 1,000,000,000");
+      stats::convergence_minimum_samples=samples;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="wang-landau-energy-bins";
+   if(word==test){
+      int bins=atoi(value.c_str());
+      check_for_valid_int(bins, word, line, prefix, 2, 1000000,"input","2 - 1,000,000");
+      sim::wang_landau_bins=bins;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="wang-landau-windows";
+   if(word==test){
+      int windows=atoi(value.c_str());
+      check_for_valid_int(windows, word, line, prefix, 1, 1000,"input","1 - 1,000");
+      sim::wang_landau_windows=windows;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="wang-landau-flatness";
+   if(word==test){
+      double flatness=atof(value.c_str());
+      check_for_valid_value(flatness, word, line, prefix, unit, "none", 0.1, 0.99,"input","0.1 - 0.99");
+      sim::wang_landau_flatness=flatness;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="wang-landau-final-modification-factor";
+   if(word==test){
+      double lnf=atof(value.c_str());
+      check_for_valid_value(lnf, word, line, prefix, unit, "none", 1.0e-12, 1.0,"input","1.0e-12 - 1.0");
+      sim::wang_landau_final_modification_factor=lnf;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="wang-landau-maximum-sweeps";
+   if(word==test){
+      int sweeps=atoi(value.c_str());
+      check_for_valid_int(sweeps, word, line, prefix, 1, 2000000000,"input","1 - 2,000,000,000");
+      sim::wang_landau_maximum_sweeps=sweeps;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
    test="save-checkpoint";
    if(word==test){
       test="end";
@@ -2594,6 +2928,18 @@ int match_vout_list(string const word, string const value, int const line, std::
       output_list.push_back(46);
       return EXIT_SUCCESS;
    }
+   //--------------------------------------------------------------------
+   test="standard-error";
+   if(word==test){
+      output_list.push_back(47);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="autocorrelation-time";
+   if(word==test){
+      output_list.push_back(48);
+      return EXIT_SUCCESS;
+   }
    //-------------------------------------------------------------------
    test="mpi-timings";
    if(word==test){
@@ -4146,6 +4492,16 @@ namespace vout{
    void material_height_mvec_actual(std::ostream& stream){
       stream << stats::material_height_magnetization.output_magnetization();
    }
+
+   // Output Function 47
+   void standard_error(std::ostream& stream){
+      stream << stats::convergence.output_standard_error();
+   }
+
+   // Output Function 48
+   void autocorrelation_time(std::ostream& stream){
+      stream << stats::convergence.output_autocorrelation_time();
+   }
 // output functions 61 added by huangtao
    void get_Ku_micromagnetism(std::ostream& stream)
    {
@@ -4340,6 +4696,12 @@ namespace vout{
             case 46:
                vout::material_height_mvec_actual(zmag);
                break;
+            case 47:
+               vout::standard_error(zmag);
+               break;
+            case 48:
+               vout::autocorrelation_time(zmag);
+               break;
             case 60:
 					vout::MPITimings(zmag);
 					break;
@@ -4352,6 +4714,9 @@ namespace vout{
 		// Carriage return
 		if(file_output_list.size()>0) zmag << std::endl;
 
+		// Output mean structure factor and correlation function to separate files
+		if(stats::calculate_structure_factor) stats::structure_factor.output(double(sim::time), sim::temperature);
+
       } // end of code for rank 0 only
    } // end of if statement for output rate
 
@@ -4481,6 +4846,12 @@ namespace vout{
             case 42:
                vout::mean_total_so_anisotropy_energy(std::cout);
                break;
+            case 47:
+               vout::standard_error(std::cout);
+               break;
+            case 48:
+               vout::autocorrelation_time(std::cout);
+               break;
             case 60:
 					vout::MPITimings(std::cout);
 					break;
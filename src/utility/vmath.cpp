@@ -43,7 +43,9 @@
 #include "vmath.hpp"
 #include "vio.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <complex>
 #include <cstdlib>
 #include <iostream>
 
@@ -501,5 +503,82 @@ double interpolate_c(double xi,double yi,double xj,double yj){
 
 }
 
+//-----------------------------------------------------
+// function to return smallest power of two >= n
+//
+int next_power_of_two(const int n){
+
+   int p=1;
+   while(p<n) p*=2;
+   return p;
+
+}
+
+//-----------------------------------------------------
+// In-place radix-2 complex fast Fourier transform of
+// a strided line of length n (power of two)
+//
+//    forward: X_k = sum_j x_j exp(-2 pi i jk/n)
+//    inverse: x_j = sum_k X_k exp(+2 pi i jk/n)
+//
+// The inverse transform is not normalised.
+//
+void fft(std::complex<double>* data, const int n, const int stride, const bool inverse){
+
+   // bit reversal permutation
+   for(int i=1, j=0; i<n; i++){
+      int bit = n >> 1;
+      for(; j & bit; bit >>= 1) j ^= bit;
+      j ^= bit;
+      if(i<j) std::swap(data[i*stride], data[j*stride]);
+   }
+
+   // butterflies
+   const double sign = inverse ? 1.0 : -1.0;
+   for(int len=2; len<=n; len <<= 1){
+      const double theta = sign*2.0*M_PI/double(len);
+      const std::complex<double> wlen(cos(theta), sin(theta));
+      const int half = len >> 1;
+      for(int i=0; i<n; i+=len){
+         std::complex<double> w(1.0,0.0);
+         for(int j=0; j<half; j++){
+            const std::complex<double> u = data[(i+j)*stride];
+            const std::complex<double> v = data[(i+j+half)*stride]*w;
+            data[(i+j)*stride] = u+v;
+            data[(i+j+half)*stride] = u-v;
+            w*=wlen;
+         }
+      }
+   }
+
+   return;
+
+}
+
+//-----------------------------------------------------
+// In-place 3D complex FFT of array stored as
+// data[(i*n[1]+j)*n[2]+k], all dimensions powers of two.
+// Transforms of length one are skipped.
+//
+void fft3d(std::vector<std::complex<double> >& data, const int n[3], const bool inverse){
+
+   if(data.size() != static_cast<unsigned int>(n[0]*n[1]*n[2])){
+      zlog << zTs() << "Error - 3D FFT array size " << data.size() << " does not match dimensions " << n[0] << " x " << n[1] << " x " << n[2] << std::endl;
+      err::vexit();
+   }
+
+   // z lines (contiguous)
+   if(n[2]>1) for(int ij=0; ij<n[0]*n[1]; ij++) fft(&data[ij*n[2]], n[2], 1, inverse);
+
+   // y lines
+   if(n[1]>1) for(int i=0; i<n[0]; i++) for(int k=0; k<n[2]; k++) fft(&data[i*n[1]*n[2]+k], n[1], n[2], inverse);
+
+   // x lines
+   if(n[0]>1) for(int jk=0; jk<n[1]*n[2]; jk++) fft(&data[jk], n[0], n[1]*n[2], inverse);
+
+   return;
+
+}
+
 } // end of namespcae vmath
 